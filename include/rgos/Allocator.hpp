@@ -0,0 +1,123 @@
+// Copyright (c) 2009 Chris Pickel <sfiera@gmail.com>
+//
+// This file is part of librgos, a free software project.  You can redistribute it and/or modify it
+// under the terms of the MIT License.
+
+#ifndef RGOS_ALLOCATOR_HPP_
+#define RGOS_ALLOCATOR_HPP_
+
+#include <stddef.h>
+#include <limits>
+#include <new>
+#include <vector>
+#include <sfz/sfz.hpp>
+
+namespace rgos {
+
+// A source of memory for Json nodes and StringMap entries.  Allocations must be aligned for any
+// scalar type.  `deallocate()` is passed the same size that was passed to `allocate()`.
+class Allocator {
+  public:
+    virtual ~Allocator();
+
+    virtual void* allocate(size_t size) = 0;
+    virtual void deallocate(void* pointer, size_t size) = 0;
+};
+
+// Returns an allocator that uses the global heap.
+Allocator* default_allocator();
+
+// Returns an allocator that serves small, fixed-size objects from size-class free lists, with a
+// cache per thread.  It is used for Json nodes and StringMap entries wherever an Allocator*
+// parameter is NULL or omitted.  Requests larger than 256 bytes go to default_allocator().
+Allocator* pool_allocator();
+
+// Carves allocations out of large blocks, and never frees them individually.  All memory is
+// returned at once by release() or by the destructor.  Every Json value and StringMap allocated
+// from a MonotonicAllocator must be destroyed before it is released.
+class MonotonicAllocator : public Allocator {
+  public:
+    explicit MonotonicAllocator(size_t block_size = 64 * 1024, Allocator* upstream = NULL);
+    virtual ~MonotonicAllocator();
+
+    virtual void* allocate(size_t size);
+    virtual void deallocate(void* pointer, size_t size);
+
+    void release();
+
+  private:
+    const size_t _block_size;
+    Allocator* const _upstream;
+    std::vector<std::pair<void*, size_t> > _blocks;
+    char* _next;
+    size_t _remaining;
+
+    DISALLOW_COPY_AND_ASSIGN(MonotonicAllocator);
+};
+
+// Base class for objects that can be placed with `new (allocator) T(...)`.  Deleting such an
+// object returns its memory to the allocator it came from, so that reference-counted and
+// linked_ptr-owned objects need not know which allocator produced them.  Plain `new T(...)` and
+// a NULL allocator use pool_allocator().
+class Allocated {
+  public:
+    static void* operator new(size_t size);
+    static void* operator new(size_t size, Allocator* allocator);
+    static void operator delete(void* pointer);
+    static void operator delete(void* pointer, Allocator* allocator);
+};
+
+// Adapts an Allocator for use with standard containers.
+template <typename T>
+class StlAllocator {
+  public:
+    typedef T           value_type;
+    typedef T*          pointer;
+    typedef const T*    const_pointer;
+    typedef T&          reference;
+    typedef const T&    const_reference;
+    typedef size_t      size_type;
+    typedef ptrdiff_t   difference_type;
+
+    template <typename U>
+    struct rebind {
+        typedef StlAllocator<U> other;
+    };
+
+    explicit StlAllocator(Allocator* allocator)
+        : _allocator(allocator ? allocator : pool_allocator()) { }
+    template <typename U>
+    StlAllocator(const StlAllocator<U>& other)
+        : _allocator(other.allocator()) { }
+
+    pointer address(reference value) const { return &value; }
+    const_pointer address(const_reference value) const { return &value; }
+
+    pointer allocate(size_type n, const void* hint = NULL) {
+        return static_cast<pointer>(_allocator->allocate(n * sizeof(T)));
+    }
+    void deallocate(pointer p, size_type n) { _allocator->deallocate(p, n * sizeof(T)); }
+
+    size_type max_size() const { return std::numeric_limits<size_type>::max() / sizeof(T); }
+    void construct(pointer p, const T& value) { new(p) T(value); }
+    void destroy(pointer p) { p->~T(); }
+
+    Allocator* allocator() const { return _allocator; }
+
+  private:
+    Allocator* _allocator;
+};
+
+template <typename T, typename U>
+bool operator==(const StlAllocator<T>& x, const StlAllocator<U>& y) {
+    return x.allocator() == y.allocator();
+}
+
+template <typename T, typename U>
+bool operator!=(const StlAllocator<T>& x, const StlAllocator<U>& y) {
+    return x.allocator() != y.allocator();
+}
+
+}  // namespace rgos
+
+#endif  // RGOS_ALLOCATOR_HPP_
@@ -0,0 +1,42 @@
+// Copyright (c) 2009 Chris Pickel <sfiera@gmail.com>
+//
+// This file is part of librgos, a free software project.  You can redistribute it and/or modify it
+// under the terms of the MIT License.
+
+#ifndef RGOS_BYTE_SINK_HPP_
+#define RGOS_BYTE_SINK_HPP_
+
+#include <stddef.h>
+#include <sfz/sfz.hpp>
+
+namespace rgos {
+
+// A destination for encoded output that may accept only part of what it is offered, such as a
+// non-blocking socket.
+class ByteSink {
+  public:
+    virtual ~ByteSink();
+
+    // Writes up to `size` bytes from `data` without blocking, and stores the number written in
+    // `written`.  Writing fewer than `size` bytes (possibly none) means that the sink is full
+    // for now.  Returns false on an error that makes the sink unusable.
+    virtual bool write(const char* data, size_t size, size_t* written) = 0;
+};
+
+// Writes to a file descriptor, which should be in non-blocking mode.  EAGAIN counts as being
+// full; EINTR is retried; any other error fails, leaving errno set.
+class FdSink : public ByteSink {
+  public:
+    explicit FdSink(int fd);
+
+    virtual bool write(const char* data, size_t size, size_t* written);
+
+  private:
+    const int _fd;
+
+    DISALLOW_COPY_AND_ASSIGN(FdSink);
+};
+
+}  // namespace rgos
+
+#endif  // RGOS_BYTE_SINK_HPP_
@@ -0,0 +1,62 @@
+// Copyright (c) 2009 Chris Pickel <sfiera@gmail.com>
+//
+// This file is part of librgos, a free software project.  You can redistribute it and/or modify it
+// under the terms of the MIT License.
+
+#ifndef RGOS_INTERNER_HPP_
+#define RGOS_INTERNER_HPP_
+
+#include <map>
+#include <vector>
+#include <sfz/sfz.hpp>
+#include <rgos/Json.hpp>
+
+namespace rgos {
+
+// Hash-consing for Json values.  Every value returned by an interner shares its node with any
+// equal value that the interner returned before, and so does each of its subtrees.  Repetitive
+// documents built through an interner therefore hold each distinct subtree only once, and
+// comparisons between interned values succeed on pointer identity.
+//
+// The interner keeps a reference to every distinct value it has returned until clear() is called
+// or it is destroyed.
+class JsonInterner {
+  public:
+    explicit JsonInterner(Allocator* allocator = NULL);
+
+    // Equivalent to the Json factories, followed by intern(), but a container's node is built only
+    // once, from its interned children.
+    Json object(const StringMap<Json>& value);
+    Json array(const std::vector<Json>& value);
+    Json string(const sfz::PrintItem& value);
+    Json number(double value);
+    Json bool_(bool value);
+
+    // Returns a value equal to `value`, built from previously interned subtrees wherever
+    // possible.
+    Json intern(const Json& value);
+
+    // The number of distinct values held.
+    size_t size() const { return _table.size(); }
+    void clear() { _table.clear(); }
+
+  private:
+    friend class InternVisitor;
+
+    // Returns the held value equal to `value`, or NULL if there is none.  A NaN matches a held NaN
+    // with the same bits.
+    const Json* find(const Json& value) const;
+
+    // Returns the held value equal to `value`, first holding `value` if there is none.  The
+    // children of `value` must already be interned.
+    Json hold(const Json& value);
+
+    Allocator* const _allocator;
+    std::multimap<size_t, Json> _table;
+
+    DISALLOW_COPY_AND_ASSIGN(JsonInterner);
+};
+
+}  // namespace rgos
+
+#endif  // RGOS_INTERNER_HPP_
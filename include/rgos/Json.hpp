@@ -9,7 +9,9 @@
 #include <map>
 #include <vector>
 #include <sfz/sfz.hpp>
+#include <rgos/Allocator.hpp>
 #include <rgos/StringMap.hpp>
+#include <rgos/Utf8.hpp>
 
 namespace rgos {
 
@@ -17,11 +19,26 @@ class JsonVisitor;
 
 class Json {
   public:
-    static Json object(const StringMap<Json>& value);
-    static Json array(const std::vector<Json>& value);
-    static Json string(const sfz::PrintItem& value);
-    static Json number(double value);
-    static Json bool_(bool value);
+    // Each factory allocates its node from `allocator`, or from pool_allocator() if it is
+    // NULL.  An object's members are copied into a StringMap using the same allocator.  The
+    // contents of arrays and strings are held in std::vector and sfz::String, and always use
+    // the global heap.
+    static Json object(const StringMap<Json>& value, Allocator* allocator = NULL);
+    static Json array(const std::vector<Json>& value, Allocator* allocator = NULL);
+    static Json string(const sfz::PrintItem& value, Allocator* allocator = NULL);
+    static Json number(double value, Allocator* allocator = NULL);
+    static Json bool_(bool value, Allocator* allocator = NULL);
+
+    // Makes a string from `size` bytes of UTF-8 at `data`, treating ill-formed input as `policy`
+    // directs (see Utf8.hpp).  Returns false, and leaves `result` unchanged, if `policy` is
+    // UTF8_REJECT and the input is ill-formed.
+    static bool string(const char* data, size_t size, Utf8Policy policy, Json* result,
+                       Allocator* allocator = NULL);
+
+    // Like object() and array(), but take the contents of `value` instead of copying them,
+    // leaving `value` empty.  The members of an adopted object stay in the allocator of `value`.
+    static Json adopt_object(StringMap<Json>* value, Allocator* allocator = NULL);
+    static Json adopt_array(std::vector<Json>* value, Allocator* allocator = NULL);
 
     Json();
     Json(const Json& other);
@@ -30,7 +47,23 @@ class Json {
 
     void accept(JsonVisitor* visitor) const;
 
+    // Structural equality.  Values that share a node are equal without examining their contents
+    // (so a shared NaN is equal to itself), and values with different hashes are unequal
+    // without examining their contents.
+    bool operator==(const Json& other) const;
+    bool operator!=(const Json& other) const;
+
+    // A hash consistent with operator==.  Each node computes its hash from its children's when it
+    // is constructed, so this is O(1).
+    size_t hash() const;
+
+    // The compact serialization of this value, if it has been memoized with memoize() (see
+    // Serialize.hpp); otherwise NULL.
+    const sfz::String* serialized() const;
+
   private:
+    friend const Json& memoize(const Json& json);
+
     class Value;
     class Object;
     class Array;
@@ -41,6 +74,10 @@ class Json {
 
     Json(Value* value);
 
+    // Stores `serialized` on this value's node, unless another thread got there first.
+    // Takes ownership of `serialized` either way.
+    void set_serialized(sfz::String* serialized) const;
+
     sfz::scoped_ref<const Value> _value;
 
     // ALLOW_COPY_AND_ASSIGN
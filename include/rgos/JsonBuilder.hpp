@@ -0,0 +1,63 @@
+// Copyright (c) 2009 Chris Pickel <sfiera@gmail.com>
+//
+// This file is part of librgos, a free software project.  You can redistribute it and/or modify it
+// under the terms of the MIT License.
+
+#ifndef RGOS_JSON_BUILDER_HPP_
+#define RGOS_JSON_BUILDER_HPP_
+
+#include <stddef.h>
+#include <sfz/sfz.hpp>
+#include <rgos/Allocator.hpp>
+#include <rgos/Json.hpp>
+
+namespace rgos {
+
+// Assembles a document by editing it in place, then freezes it into an immutable Json.
+//
+// Paths are JSON Pointers (RFC 6901), such as "/servers/0/port"; the empty path refers to the
+// whole document.  Objects that are missing along a path, or that are null, are created; in an
+// array, the token "-" refers to a new element after the last one.  A Json that is stored and
+// later edited through a path is thawed by copying its top level only, so its untouched
+// subtrees are shared with the result.
+//
+// Containers that are being edited are kept as mutable maps and vectors, which freeze() hands to
+// Json::adopt_object() and Json::adopt_array() instead of copying.
+class JsonBuilder {
+  public:
+    // Begins with a null document.  The containers of the result are allocated from `allocator`,
+    // or from pool_allocator() if it is NULL.
+    explicit JsonBuilder(Allocator* allocator = NULL);
+    ~JsonBuilder();
+
+    // Stores `value` at `path`, replacing any value that was there.  Returns false, and leaves the
+    // document unchanged, if `path` is malformed, passes through a value that is not a container,
+    // or names an array element that does not exist.
+    bool set(const sfz::StringSlice& path, const Json& value);
+
+    // Appends `value` to the array at `path`, creating the array if it is missing or null.
+    // Returns false, and leaves the document unchanged, if `path` is malformed or refers to a value
+    // that is not an array.
+    bool append(const sfz::StringSlice& path, const Json& value);
+
+    // Reserves room for `capacity` elements in the array at `path`, creating it as append() does.
+    bool reserve(const sfz::StringSlice& path, size_t capacity);
+
+    // Returns the document and resets the builder to a null document.
+    Json freeze();
+
+  private:
+    class Node;
+
+    // Returns the array at `path`, opened for editing and created if it is missing or null.
+    Node* open_array(const sfz::StringSlice& path);
+
+    Allocator* const _allocator;
+    sfz::scoped_ptr<Node> _root;
+
+    DISALLOW_COPY_AND_ASSIGN(JsonBuilder);
+};
+
+}  // namespace rgos
+
+#endif  // RGOS_JSON_BUILDER_HPP_
@@ -0,0 +1,101 @@
+// Copyright (c) 2009 Chris Pickel <sfiera@gmail.com>
+//
+// This file is part of librgos, a free software project.  You can redistribute it and/or modify it
+// under the terms of the MIT License.
+
+#ifndef RGOS_JSON_WALKER_HPP_
+#define RGOS_JSON_WALKER_HPP_
+
+#include <vector>
+#include <sfz/sfz.hpp>
+#include <rgos/Json.hpp>
+#include <rgos/StringMap.hpp>
+
+namespace rgos {
+
+// Receives a depth-first sequence of events describing a Json value.  Unlike JsonVisitor, the
+// visitor does not descend into containers itself: the walker does, and reports each member
+// of an object or array between begin_*() and end_*().
+//
+// Each event returns an Action, which lets a visitor prune the walk or end it early:
+//
+//   CONTINUE: carry on.
+//   SKIP:     from enter_value(), generate no further events for the value.  From begin_*(), skip
+//             the container's members and go straight to its end_*().  From object_key() or
+//             array_element(), skip that member's value.  Elsewhere, the same as CONTINUE.
+//   STOP:     end the walk immediately.  No further events are generated, not even end_*() for
+//             the containers that are open.
+class JsonEventVisitor {
+  public:
+    enum Action {
+        CONTINUE,
+        SKIP,
+        STOP
+    };
+
+    virtual ~JsonEventVisitor();
+
+    // Called before the events for each value, including the root.  The default returns
+    // CONTINUE.
+    virtual Action enter_value(const Json& value);
+
+    virtual Action begin_object(const StringMap<Json>& value) = 0;
+    virtual Action object_key(const sfz::StringSlice& key, size_t index) = 0;
+    virtual Action end_object(const StringMap<Json>& value) = 0;
+
+    virtual Action begin_array(const std::vector<Json>& value) = 0;
+    virtual Action array_element(size_t index) = 0;
+    virtual Action end_array(const std::vector<Json>& value) = 0;
+
+    virtual Action visit_string(const sfz::StringSlice& value) = 0;
+    virtual Action visit_number(double value) = 0;
+    virtual Action visit_bool(bool value) = 0;
+    virtual Action visit_null() = 0;
+};
+
+// Walks a Json value depth-first using an explicit stack, so that the depth of a document is
+// limited only by memory, not by the call stack.  The walk can be advanced a step at a time,
+// and paused between steps.
+class JsonWalker {
+  public:
+    explicit JsonWalker(const Json& json);
+
+    // Starts a new walk of `json`, keeping the memory allocated for the old one.
+    void reset(const Json& json);
+
+    // Generates the events for the next value (preceded by its key or index, if it is in a
+    // container), or for the end of the innermost open container.  Returns false, without
+    // generating any events, once the walk is complete or a visitor has returned STOP.
+    bool step(JsonEventVisitor* visitor);
+
+    bool done() const { return _stopped || (_started && _stack.empty()); }
+    bool stopped() const { return _stopped; }
+
+  private:
+    struct Frame {
+        const StringMap<Json>* object;
+        StringMap<Json>::const_iterator member;
+        const std::vector<Json>* array;
+        size_t index;
+    };
+
+    void enter(const Json& value, JsonEventVisitor* visitor);
+
+    // Records a STOP, if `action` is one.  Returns true if the value that the event belongs to
+    // should be walked further.
+    bool proceed(JsonEventVisitor::Action action);
+
+    Json _root;
+    bool _started;
+    bool _stopped;
+    std::vector<Frame> _stack;
+
+    DISALLOW_COPY_AND_ASSIGN(JsonWalker);
+};
+
+// Walks `json`, sending its events to `visitor`.  Returns false if the visitor stopped the walk.
+bool walk(const Json& json, JsonEventVisitor* visitor);
+
+}  // namespace rgos
+
+#endif  // RGOS_JSON_WALKER_HPP_
@@ -0,0 +1,35 @@
+// Copyright (c) 2009 Chris Pickel <sfiera@gmail.com>
+//
+// This file is part of librgos, a free software project.  You can redistribute it and/or modify it
+// under the terms of the MIT License.
+
+#ifndef RGOS_PATCH_HPP_
+#define RGOS_PATCH_HPP_
+
+#include <rgos/Json.hpp>
+
+namespace rgos {
+
+// Returns a JSON Patch (RFC 6902) that turns `from` into `to`: an array of operations such as
+// {"op": "replace", "path": "/servers/0/port", "value": 8080}.  Only "add", "remove" and
+// "replace" are generated.
+//
+// Subtrees are compared with operator== before being descended into, so a subtree that shares
+// its node with the other side is skipped in O(1).  Documents that are updated by rebuilding
+// only the changed paths (as apply_patch() does) can therefore be diffed in time proportional to
+// the change, not to their size.  Arrays are diffed by trimming their common prefix and suffix
+// and then comparing element by element, so insertions and removals in the middle of an array
+// may be expressed as a run of replacements.
+Json diff(const Json& from, const Json& to);
+
+// Applies `patch`, an array of RFC 6902 operations, to `json`.  All six operations ("add",
+// "remove", "replace", "move", "copy" and "test") are supported.  Only the containers along each
+// operation's path are rebuilt; every other subtree of the result shares its node with `json`.
+//
+// Returns false, and leaves `result` unchanged, if an operation is malformed, refers to a path
+// that does not exist, or is a failed "test".
+bool apply_patch(const Json& json, const Json& patch, Json* result);
+
+}  // namespace rgos
+
+#endif  // RGOS_PATCH_HPP_
@@ -6,19 +6,129 @@
 #ifndef RGOS_SERIALIZE_HPP_
 #define RGOS_SERIALIZE_HPP_
 
+#include <stdint.h>
+#include <vector>
 #include <sfz/sfz.hpp>
 
 namespace rgos {
 
+class ByteSink;
 class Json;
 
+struct JsonCanonicalPrinter;
 struct JsonPrettyPrinter;
 
+// Layout options for pretty_print().  The defaults indent each level by two spaces and put
+// every array element on its own line.
+struct PrettyPrintStyle {
+    PrettyPrintStyle();
+
+    int indent;             // Spaces, or tabs if `tabs` is set, per level.
+    bool tabs;              // Indent with tabs instead of spaces.
+    size_t compact_arrays;  // Print arrays of up to this many scalars on one line: [1, 2, 3].
+};
+
 JsonPrettyPrinter pretty_print(const Json& value);
+JsonPrettyPrinter pretty_print(const Json& value, const PrettyPrintStyle& style);
 
-struct JsonPrettyPrinter { const Json& json; };
+struct JsonPrettyPrinter { const Json& json; PrettyPrintStyle style; };
 void print_to(sfz::PrintTarget out, const JsonPrettyPrinter& j);
 
+// Prints `value` in a canonical form, so that equal values print identically however they were
+// built: compact, with object members ordered by code point (StringSliceLess, the order in which
+// a StringMap<Json> iterates), numbers in the shortest form that reads back exactly, and strings
+// with only the escapes JSON requires.
+// Integers up to 2^53 are written in full, without an exponent, and -0 as 0; NaN and infinities,
+// which JSON cannot represent, are written as null.  Memoized serializations are not used.
+JsonCanonicalPrinter canonical(const Json& value);
+
+struct JsonCanonicalPrinter { const Json& json; };
+void print_to(sfz::PrintTarget out, const JsonCanonicalPrinter& j);
+
+// The XXH64 hash (see Xxh64.hpp) of print_to(canonical(json)), encoded as UTF-8.  The hash is
+// computed as the output is formatted, so the string is never built.  Suitable as a cache key
+// for requests that are stored as Json.
+uint64_t canonical_hash(const Json& json, uint64_t seed = 0);
+
+// The exact number of characters that print_to() would write for `json`.  Memoized subtrees
+// (see memoize()) are measured in O(1); anything else is formatted and discarded.  Pretty sizes
+// are never cached: they depend on the style and on the depth of each subtree, so the whole value
+// is always formatted.
+size_t serialized_size(const Json& json);
+size_t serialized_size(const JsonPrettyPrinter& json);
+
+// Appends the serialization of `json` to `out`, reserving the exact space first so that `out`
+// grows at most once.  Measuring costs roughly a quarter of a print, so this saves little time
+// unless repeated reallocation and copying dominate; its main gain is lower peak memory.
+void append_json(sfz::String* out, const Json& json);
+void append_json(sfz::String* out, const JsonPrettyPrinter& json);
+
+// Stores the compact serialization of `json` on its node, so that print_to() of `json`, or of
+// any value that contains it, copies the stored text instead of walking the subtree.  Since
+// nodes never change, the stored text never needs to be invalidated.  Worthwhile for large,
+// static subtrees that are embedded in many documents.  Memoizing a value again, or memoizing
+// null, does nothing.  Returns `json`.
+const Json& memoize(const Json& json);
+
+// Serializes a value as UTF-8 into a ByteSink a piece at a time, so that a large document can be
+// sent to a non-blocking socket from an event loop without being formatted in full first.  Each
+// call to write() sends as much as the sink accepts and returns once it is full; the next call
+// resumes where that one left off.  The output is that of print_to(), encoded as UTF-8.
+//
+// About `chunk_size` bytes are formatted ahead of the sink at a time, or more if a single string
+// or memoized subtree is larger than that.  The writer holds a reference to the value.
+class JsonWriter {
+  public:
+    enum Status {
+        COMPLETE,     // Everything has been written.
+        WOULD_BLOCK,  // The sink is full; call write() again once it can accept more.
+        SINK_ERROR    // The sink failed.  Every later call returns SINK_ERROR too.
+    };
+
+    explicit JsonWriter(const Json& json, size_t chunk_size = 16384);
+    explicit JsonWriter(const JsonPrettyPrinter& json, size_t chunk_size = 16384);
+    ~JsonWriter();
+
+    Status write(ByteSink* sink);
+
+  private:
+    class State;
+
+    sfz::scoped_ptr<State> _state;
+
+    DISALLOW_COPY_AND_ASSIGN(JsonWriter);
+};
+
+// Writes values as newline-delimited JSON: each value's compact serialization, encoded as UTF-8,
+// followed by "\n".  Records are formatted into one buffer, which is reused, and passed to the
+// sink in large writes instead of one write per record.
+//
+// write() buffers its values, and flushes once at least `flush_size` bytes are pending.  If the
+// sink is full, the output stays buffered (and the buffer grows) until a later flush.  Call
+// flush() until it returns COMPLETE before destroying the writer; unflushed output is dropped.
+class NdjsonWriter {
+  public:
+    explicit NdjsonWriter(ByteSink* sink, size_t flush_size = 65536);
+    ~NdjsonWriter();
+
+    // Return false if the sink has failed.
+    bool write(const Json& value);
+    bool write(const std::vector<Json>& values);
+
+    // Writes as much pending output as the sink accepts.
+    JsonWriter::Status flush();
+
+    // The number of bytes written to the buffer but not yet to the sink.
+    size_t pending() const;
+
+  private:
+    class State;
+
+    sfz::scoped_ptr<State> _state;
+
+    DISALLOW_COPY_AND_ASSIGN(NdjsonWriter);
+};
+
 }  // namespace rgos
 
 #endif  // RGOS_SERIALIZE_HPP_
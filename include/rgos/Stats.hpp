@@ -0,0 +1,50 @@
+// Copyright (c) 2009 Chris Pickel <sfiera@gmail.com>
+//
+// This file is part of librgos, a free software project.  You can redistribute it and/or modify it
+// under the terms of the MIT License.
+
+#ifndef RGOS_STATS_HPP_
+#define RGOS_STATS_HPP_
+
+#include <stdint.h>
+
+namespace rgos {
+
+class Json;
+
+// Process-wide counters describing the work done by librgos.  Counting is compiled in only when
+// RGOS_STATS is defined (with gyp, pass -Drgos_stats=1); otherwise the hooks expand to nothing
+// and json_stats() always reports zeroes.
+struct JsonStats {
+    uint64_t allocations;         // Json nodes and StringMap entries allocated.
+    uint64_t allocated_bytes;     // Total size of those allocations.
+    uint64_t string_map_lookups;  // Calls to StringMap::find(), insert() and operator[].
+    uint64_t serializations;      // print_to(), canonical_hash(), JsonWriters and NDJSON records.
+    uint64_t serialized_chars;    // Characters written by those calls.
+    uint64_t serialize_usecs;     // Wall time spent in those calls, or until a writer completes.
+};
+
+JsonStats json_stats();
+void reset_json_stats();
+
+// Returns `stats` as an object mapping each field name above to its value.
+Json stats_to_json(const JsonStats& stats);
+
+#ifdef RGOS_STATS
+
+namespace internal {
+extern JsonStats json_stats;
+}  // namespace internal
+
+#define RGOS_STATS_ADD(FIELD, N) \
+    __sync_fetch_and_add(&::rgos::internal::json_stats.FIELD, static_cast<uint64_t>(N))
+
+#else  // RGOS_STATS
+
+#define RGOS_STATS_ADD(FIELD, N) static_cast<void>(0)
+
+#endif  // RGOS_STATS
+
+}  // namespace rgos
+
+#endif  // RGOS_STATS_HPP_
@@ -6,14 +6,78 @@
 #ifndef RGOS_STRING_MAP_HPP_
 #define RGOS_STRING_MAP_HPP_
 
+#include <algorithm>
 #include <map>
 #include <utility>
+#include <stdint.h>
 #include <stdlib.h>
 #include <sfz/sfz.hpp>
+#include <rgos/Allocator.hpp>
+#include <rgos/Stats.hpp>
 
 namespace rgos {
 
-struct StringSliceLess;
+// Orders keys lexicographically by code point.
+struct StringSliceLess {
+    bool operator()(const sfz::StringSlice& lhs, const sfz::StringSlice& rhs) const {
+        const size_t size = std::min(lhs.size(), rhs.size());
+        for (size_t i = 0; i < size; ++i) {
+            const sfz::Rune l = lhs.at(i);
+            const sfz::Rune r = rhs.at(i);
+            if (l != r) {
+                return l < r;
+            }
+        }
+        return lhs.size() < rhs.size();
+    }
+};
+
+namespace internal {
+
+// A key as stored in a StringMap's tree, with its first eight code points packed into a word,
+// one byte each and zero-padded.  A code point of U+00FF or above is packed as 0xff and ends the
+// packing, since the code points after it could not be compared byte by byte.  So if one key is
+// less than another, its prefix word is less than or equal to the other's, and keys whose prefix
+// words differ can be ordered without looking at their text.
+struct StringMapKey {
+    explicit StringMapKey(const sfz::StringSlice& key)
+        : slice(key),
+          prefix(0) {
+        bool clamped = false;
+        for (size_t i = 0; i < 8; ++i) {
+            prefix <<= 8;
+            if (!clamped && (i < key.size())) {
+                const sfz::Rune rune = key.at(i);
+                clamped = (rune >= 0xff);
+                prefix |= clamped ? 0xff : rune;
+            }
+        }
+    }
+
+    sfz::StringSlice slice;
+    uint64_t prefix;
+};
+
+template <typename Compare>
+struct StringMapKeyLess {
+    bool operator()(const StringMapKey& lhs, const StringMapKey& rhs) const {
+        return less(lhs.slice, rhs.slice);
+    }
+    Compare less;
+};
+
+// Only lexicographic order agrees with the prefix word, so only it takes the shortcut.
+template <>
+struct StringMapKeyLess<StringSliceLess> {
+    bool operator()(const StringMapKey& lhs, const StringMapKey& rhs) const {
+        if (lhs.prefix != rhs.prefix) {
+            return lhs.prefix < rhs.prefix;
+        }
+        return StringSliceLess()(lhs.slice, rhs.slice);
+    }
+};
+
+}  // namespace internal
 
 template <typename T, typename Compare = StringSliceLess>
 class StringMap {
@@ -26,8 +90,12 @@ class StringMap {
     class iterator;
     class const_iterator;
 
-    StringMap() { }
-    explicit StringMap(const StringMap& other);
+    // Entries (and the internal tree nodes that index them) are allocated from `allocator`, or
+    // from pool_allocator() if it is NULL.  The text of each key is copied into an
+    // sfz::String, which always uses the global heap.
+    StringMap() : _map(key_compare(), map_allocator(NULL)) { }
+    explicit StringMap(Allocator* allocator) : _map(key_compare(), map_allocator(allocator)) { }
+    explicit StringMap(const StringMap& other, Allocator* allocator = NULL);
     ~StringMap() { }
 
     mapped_type& operator[](const key_type& key);
@@ -39,10 +107,16 @@ class StringMap {
     void clear() { _map.clear(); }
     void erase(iterator pos) { _map.erase(pos); }
     void erase(iterator start, iterator end) { _map.erase(start, end); }
-    size_type erase(const key_type& key) { return _map.erase(key); }
+    size_type erase(const key_type& key) { return _map.erase(internal::StringMapKey(key)); }
 
-    iterator find(const key_type& key) { return _map.find(key); }
-    const_iterator find(const key_type& key) const { return _map.find(key); }
+    iterator find(const key_type& key) {
+        RGOS_STATS_ADD(string_map_lookups, 1);
+        return _map.find(internal::StringMapKey(key));
+    }
+    const_iterator find(const key_type& key) const {
+        RGOS_STATS_ADD(string_map_lookups, 1);
+        return _map.find(internal::StringMapKey(key));
+    }
 
     iterator begin() { return _map.begin(); }
     const_iterator begin() const { return _map.begin(); }
@@ -55,13 +129,20 @@ class StringMap {
 
     void swap(StringMap& from) { _map.swap(from._map); }
 
+    Allocator* allocator() const { return _map.get_allocator().allocator(); }
+
   private:
     struct WrappedValue;
-    typedef std::map<sfz::StringSlice, sfz::linked_ptr<WrappedValue>, Compare> internal_map;
+    typedef internal::StringMapKeyLess<Compare> key_compare;
+    typedef std::pair<const internal::StringMapKey, sfz::linked_ptr<WrappedValue> >
+        internal_value;
+    typedef StlAllocator<internal_value> map_allocator;
+    typedef std::map<internal::StringMapKey, sfz::linked_ptr<WrappedValue>, key_compare,
+                     map_allocator> internal_map;
     typedef typename internal_map::iterator wrapped_iterator;
     typedef typename internal_map::const_iterator wrapped_const_iterator;
 
-    struct WrappedValue {
+    struct WrappedValue : public Allocated {
         const sfz::String key_storage;
         std::pair<const sfz::StringSlice, mapped_type> pair;
 
@@ -131,7 +212,8 @@ class StringMap<T, Compare>::const_iterator : public iterator_base<wrapped_const
 };
 
 template <typename T, typename Compare>
-StringMap<T, Compare>::StringMap(const StringMap& other) {
+StringMap<T, Compare>::StringMap(const StringMap& other, Allocator* allocator)
+    : _map(key_compare(), map_allocator(allocator)) {
     foreach (const value_type& item, other) {
         insert(item);
     }
@@ -140,10 +222,14 @@ StringMap<T, Compare>::StringMap(const StringMap& other) {
 template <typename T, typename Compare>
 typename StringMap<T, Compare>::mapped_type& StringMap<T, Compare>::operator[](
         const key_type& key) {
-    wrapped_iterator it = _map.find(key);
+    RGOS_STATS_ADD(string_map_lookups, 1);
+    wrapped_iterator it = _map.find(internal::StringMapKey(key));
     if (it == _map.end()) {
-        sfz::linked_ptr<WrappedValue> inserted(new WrappedValue(key));
-        _map.insert(typename internal_map::value_type(inserted->key_storage, inserted));
+        RGOS_STATS_ADD(allocations, 1);
+        RGOS_STATS_ADD(allocated_bytes, sizeof(WrappedValue));
+        sfz::linked_ptr<WrappedValue> inserted(new (allocator()) WrappedValue(key));
+        _map.insert(typename internal_map::value_type(
+                    internal::StringMapKey(inserted->key_storage), inserted));
         return inserted->pair.second;
     }
     return it->second->pair.second;
@@ -154,33 +240,21 @@ std::pair<typename StringMap<T, Compare>::iterator, bool> StringMap<T, Compare>:
         const value_type& pair) {
     const sfz::StringSlice& key = pair.first;
     const mapped_type& value = pair.second;
-    wrapped_iterator it = _map.find(key);
+    RGOS_STATS_ADD(string_map_lookups, 1);
+    wrapped_iterator it = _map.find(internal::StringMapKey(key));
     if (it == _map.end()) {
-        sfz::linked_ptr<WrappedValue> inserted(new WrappedValue(key, value));
-        it = _map.insert(typename internal_map::value_type(inserted->key_storage, inserted)).first;
-        return make_pair(iterator(it), true);
+        RGOS_STATS_ADD(allocations, 1);
+        RGOS_STATS_ADD(allocated_bytes, sizeof(WrappedValue));
+        sfz::linked_ptr<WrappedValue> inserted(
+                new (allocator()) WrappedValue(key, value));
+        it = _map.insert(typename internal_map::value_type(
+                    internal::StringMapKey(inserted->key_storage), inserted)).first;
+        return std::make_pair(iterator(it), true);
     } else {
-        return make_pair(iterator(it), false);
+        return std::make_pair(iterator(it), false);
     }
 }
 
-struct StringSliceLess {
-    bool operator()(const sfz::StringSlice& lhs, const sfz::StringSlice& rhs) const {
-        for (sfz::StringSlice::const_iterator it = lhs.begin(), jt = rhs.begin(),
-                it_end = rhs.end(), jt_end = rhs.end(); true; ++it, ++jt) {
-            if (jt == jt_end) {
-                return false;
-            } else if (it == it_end) {
-                return true;
-            } else if (*it < *jt) {
-                return true;
-            } else if (*jt < *it) {
-                return false;
-            }
-        }
-    }
-};
-
 }  // namespace rgos
 
 #endif  // RGOS_STRING_MAP_HPP_
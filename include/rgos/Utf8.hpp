@@ -0,0 +1,41 @@
+// Copyright (c) 2009 Chris Pickel <sfiera@gmail.com>
+//
+// This file is part of librgos, a free software project.  You can redistribute it and/or modify it
+// under the terms of the MIT License.
+
+#ifndef RGOS_UTF8_HPP_
+#define RGOS_UTF8_HPP_
+
+#include <stddef.h>
+#include <sfz/sfz.hpp>
+
+namespace rgos {
+
+// What to do with bytes that are not well-formed UTF-8 (including overlong forms, surrogates,
+// code points above U+10FFFF and truncated sequences).
+enum Utf8Policy {
+    UTF8_REJECT,        // Fail.
+    UTF8_REPLACE,       // Substitute U+FFFD for each maximal ill-formed subsequence.
+    UTF8_PASS_THROUGH   // Decode each byte of the subsequence as the code point of equal value.
+};
+
+// The length of the longest prefix of `data` that is well-formed UTF-8.  Runs of ASCII are
+// checked 16 bytes at a time where SSE2 is available, and 8 at a time otherwise.
+size_t valid_utf8_prefix(const char* data, size_t size);
+
+bool is_valid_utf8(const char* data, size_t size);
+
+// Decodes `data` in a single pass, appending the code points to `out`.  With UTF8_REJECT, returns
+// false on ill-formed input and leaves `out` unchanged; otherwise always returns true.  Runs of
+// ASCII are found as valid_utf8_prefix() finds them, but are still appended one code point at a
+// time, since sfz::String has no bulk append from bytes; room for them is reserved up front.
+bool decode_utf8(const char* data, size_t size, Utf8Policy policy, sfz::String* out);
+
+// Writes the UTF-8 encoding of `rune` to `out`, which must have room for four bytes, and returns
+// its length.  Surrogates and values above U+10FFFF, which have no encoding, are written as
+// U+FFFD.
+size_t encode_utf8(sfz::Rune rune, char* out);
+
+}  // namespace rgos
+
+#endif  // RGOS_UTF8_HPP_
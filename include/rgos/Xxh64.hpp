@@ -0,0 +1,40 @@
+// Copyright (c) 2009 Chris Pickel <sfiera@gmail.com>
+//
+// This file is part of librgos, a free software project.  You can redistribute it and/or modify it
+// under the terms of the MIT License.
+
+#ifndef RGOS_XXH64_HPP_
+#define RGOS_XXH64_HPP_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sfz/sfz.hpp>
+
+namespace rgos {
+
+// Computes the 64-bit xxHash (XXH64) of a byte stream that is fed to it in pieces of any size.
+// The result is the same as for the concatenated input, and is the same on every platform.
+class Xxh64 {
+  public:
+    explicit Xxh64(uint64_t seed = 0);
+
+    void update(const char* data, size_t size);
+
+    // The hash of everything passed to update() so far.  More input may follow.
+    uint64_t digest() const;
+
+  private:
+    uint64_t _accumulators[4];
+    const uint64_t _seed;
+    uint64_t _total_size;
+    char _stripe[32];  // Input that does not yet fill a stripe.
+    size_t _stripe_size;
+
+    DISALLOW_COPY_AND_ASSIGN(Xxh64);
+};
+
+uint64_t xxh64(const char* data, size_t size, uint64_t seed = 0);
+
+}  // namespace rgos
+
+#endif  // RGOS_XXH64_HPP_
@@ -6,9 +6,18 @@
 #ifndef RGOS_RGOS_HPP_
 #define RGOS_RGOS_HPP_
 
+#include <rgos/Allocator.hpp>
+#include <rgos/ByteSink.hpp>
+#include <rgos/Interner.hpp>
 #include <rgos/Json.hpp>
+#include <rgos/JsonBuilder.hpp>
 #include <rgos/JsonVisitor.hpp>
+#include <rgos/JsonWalker.hpp>
+#include <rgos/Patch.hpp>
 #include <rgos/Serialize.hpp>
+#include <rgos/Stats.hpp>
 #include <rgos/StringMap.hpp>
+#include <rgos/Utf8.hpp>
+#include <rgos/Xxh64.hpp>
 
 #endif  // RGOS_RGOS_HPP_
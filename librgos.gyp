@@ -1,12 +1,25 @@
 {
+    'variables': {
+        'rgos_stats%': 0,
+    },
     'targets': [
         {
             'target_name': 'librgos',
             'type': '<(library)',
             'sources': [
+                'src/rgos/Allocator.cpp',
+                'src/rgos/ByteSink.cpp',
+                'src/rgos/Interner.cpp',
                 'src/rgos/Json.cpp',
+                'src/rgos/JsonBuilder.cpp',
+                'src/rgos/JsonPointer.cpp',
                 'src/rgos/JsonVisitor.cpp',
+                'src/rgos/JsonWalker.cpp',
+                'src/rgos/Patch.cpp',
                 'src/rgos/Serialize.cpp',
+                'src/rgos/Stats.cpp',
+                'src/rgos/Utf8.cpp',
+                'src/rgos/Xxh64.cpp',
             ],
             'include_dirs': [
                 'include',
@@ -22,18 +35,60 @@
             'export_dependent_settings': [
                 '<(DEPTH)/ext/libsfz/libsfz.gyp:libsfz',
             ],
+            'link_settings': {
+                'libraries': [
+                    '-lpthread',
+                ],
+            },
+            'conditions': [
+                ['rgos_stats == 1', {
+                    'defines': [
+                        'RGOS_STATS',
+                    ],
+                    'direct_dependent_settings': {
+                        'defines': [
+                            'RGOS_STATS',
+                        ],
+                    },
+                }],
+            ],
         },
         {
             'target_name': 'librgos-tests',
             'type': 'executable',
             'sources': [
+                'src/rgos/Allocator.test.cpp',
+                'src/rgos/ByteSink.test.cpp',
+                'src/rgos/Interner.test.cpp',
                 'src/rgos/Json.test.cpp',
+                'src/rgos/JsonBuilder.test.cpp',
+                'src/rgos/JsonWalker.test.cpp',
+                'src/rgos/Patch.test.cpp',
                 'src/rgos/Serialize.test.cpp',
+                'src/rgos/Stats.test.cpp',
+                'src/rgos/StringMap.test.cpp',
+                'src/rgos/Utf8.test.cpp',
+                'src/rgos/Xxh64.test.cpp',
             ],
             'dependencies': [
                 ':librgos',
                 '<(DEPTH)/ext/googlemock/googlemock.gyp:gmock_main',
             ],
         },
+        {
+            'target_name': 'librgos-bench',
+            'type': 'executable',
+            'sources': [
+                'src/rgos/Bench.cpp',
+                'src/rgos/Json.bench.cpp',
+                'src/rgos/Patch.bench.cpp',
+                'src/rgos/Serialize.bench.cpp',
+                'src/rgos/StringMap.bench.cpp',
+                'src/rgos/Utf8.bench.cpp',
+            ],
+            'dependencies': [
+                ':librgos',
+            ],
+        },
     ],
 }
@@ -0,0 +1,268 @@
+// Copyright (c) 2009 Chris Pickel <sfiera@gmail.com>
+//
+// This file is part of librgos, a free software project.  You can redistribute it and/or modify it
+// under the terms of the MIT License.
+
+#include "rgos/Allocator.hpp"
+
+#include <pthread.h>
+
+using std::make_pair;
+
+namespace rgos {
+
+namespace {
+
+// Every allocation is rounded up to, and aligned on, a multiple of this.
+const size_t kAlignment = 16;
+
+size_t align(size_t size) {
+    return (size + kAlignment - 1) & ~(kAlignment - 1);
+}
+
+// Uses the global operator new, so that replacements of it (e.g. by librgos-bench) see every
+// allocation made by librgos.
+class HeapAllocator : public Allocator {
+  public:
+    HeapAllocator() { }
+
+    virtual void* allocate(size_t size) {
+        return ::operator new(size);
+    }
+
+    virtual void deallocate(void* pointer, size_t size) {
+        ::operator delete(pointer);
+    }
+
+  private:
+    DISALLOW_COPY_AND_ASSIGN(HeapAllocator);
+};
+
+// Serves allocations of up to kPoolClasses * kAlignment bytes from per-size-class free lists;
+// larger allocations are passed to the default allocator.  Each thread keeps its own free lists,
+// so that most allocations and deallocations take no lock.  A thread whose list for a class runs
+// dry takes a batch of blocks from the shared lists (carving a new slab from the default
+// allocator if those are also empty); a thread whose list grows long gives a batch back.  Slabs
+// are never returned to the default allocator.
+class PoolAllocator : public Allocator {
+  public:
+    PoolAllocator() {
+        pthread_mutex_init(&_mutex, NULL);
+        pthread_key_create(&_cache_key, flush_cache);
+        for (size_t i = 0; i < kPoolClasses; ++i) {
+            _shared[i].head = NULL;
+            _shared[i].size = 0;
+        }
+    }
+
+    virtual void* allocate(size_t size) {
+        if ((size == 0) || (size > kPoolMaxSize)) {
+            return default_allocator()->allocate(size);
+        }
+        FreeList* list = &thread_cache()->lists[size_class(size)];
+        if (list->head == NULL) {
+            refill(size_class(size), list);
+        }
+        FreeBlock* block = list->head;
+        list->head = block->next;
+        --list->size;
+        return block;
+    }
+
+    virtual void deallocate(void* pointer, size_t size) {
+        if ((size == 0) || (size > kPoolMaxSize)) {
+            default_allocator()->deallocate(pointer, size);
+            return;
+        }
+        FreeList* list = &thread_cache()->lists[size_class(size)];
+        FreeBlock* block = static_cast<FreeBlock*>(pointer);
+        block->next = list->head;
+        list->head = block;
+        ++list->size;
+        if (list->size >= 2 * kPoolBatch) {
+            pthread_mutex_lock(&_mutex);
+            move(list, &_shared[size_class(size)], kPoolBatch);
+            pthread_mutex_unlock(&_mutex);
+        }
+    }
+
+  private:
+    static const size_t kPoolClasses = 16;
+    static const size_t kPoolMaxSize = kPoolClasses * kAlignment;
+    static const size_t kPoolBatch = 64;
+    static const size_t kPoolSlabSize = 64 * 1024;
+
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    struct FreeList {
+        FreeBlock* head;
+        size_t size;
+    };
+
+    struct ThreadCache {
+        PoolAllocator* pool;
+        FreeList lists[kPoolClasses];
+    };
+
+    static size_t size_class(size_t size) {
+        return (size - 1) / kAlignment;
+    }
+
+    static void move(FreeList* from, FreeList* to, size_t count) {
+        while ((count-- > 0) && (from->head != NULL)) {
+            FreeBlock* block = from->head;
+            from->head = block->next;
+            --from->size;
+            block->next = to->head;
+            to->head = block;
+            ++to->size;
+        }
+    }
+
+    ThreadCache* thread_cache() {
+        ThreadCache* cache = static_cast<ThreadCache*>(pthread_getspecific(_cache_key));
+        if (cache == NULL) {
+            cache = new ThreadCache;
+            cache->pool = this;
+            for (size_t i = 0; i < kPoolClasses; ++i) {
+                cache->lists[i].head = NULL;
+                cache->lists[i].size = 0;
+            }
+            pthread_setspecific(_cache_key, cache);
+        }
+        return cache;
+    }
+
+    void refill(size_t size_class, FreeList* list) {
+        pthread_mutex_lock(&_mutex);
+        FreeList* shared = &_shared[size_class];
+        if (shared->head == NULL) {
+            const size_t block_size = (size_class + 1) * kAlignment;
+            char* slab = static_cast<char*>(default_allocator()->allocate(kPoolSlabSize));
+            for (size_t offset = 0; offset + block_size <= kPoolSlabSize; offset += block_size) {
+                FreeBlock* block = reinterpret_cast<FreeBlock*>(slab + offset);
+                block->next = shared->head;
+                shared->head = block;
+                ++shared->size;
+            }
+        }
+        move(shared, list, kPoolBatch);
+        pthread_mutex_unlock(&_mutex);
+    }
+
+    // Called on thread exit: returns the thread's cached blocks to the shared lists.
+    static void flush_cache(void* pointer) {
+        ThreadCache* cache = static_cast<ThreadCache*>(pointer);
+        PoolAllocator* pool = cache->pool;
+        pthread_mutex_lock(&pool->_mutex);
+        for (size_t i = 0; i < kPoolClasses; ++i) {
+            move(&cache->lists[i], &pool->_shared[i], cache->lists[i].size);
+        }
+        pthread_mutex_unlock(&pool->_mutex);
+        delete cache;
+    }
+
+    pthread_mutex_t _mutex;
+    pthread_key_t _cache_key;
+    FreeList _shared[kPoolClasses];
+
+    DISALLOW_COPY_AND_ASSIGN(PoolAllocator);
+};
+
+// Precedes each Allocated object, recording where its memory came from.  Padded so that the
+// object that follows is aligned as strictly as malloc() would align it.
+union AllocatedHeader {
+    struct {
+        Allocator* allocator;
+        size_t size;
+    } block;
+    char padding[kAlignment];
+};
+
+}  // namespace
+
+Allocator::~Allocator() { }
+
+Allocator* default_allocator() {
+    // Never destroyed, like pool_allocator(), which frees its slabs through this one.
+    static HeapAllocator* allocator = new HeapAllocator;
+    return allocator;
+}
+
+Allocator* pool_allocator() {
+    // Never destroyed: blocks may be freed by static destructors and exiting threads.
+    static PoolAllocator* allocator = new PoolAllocator;
+    return allocator;
+}
+
+MonotonicAllocator::MonotonicAllocator(size_t block_size, Allocator* upstream)
+    : _block_size(align(block_size)),
+      _upstream(upstream ? upstream : default_allocator()),
+      _next(NULL),
+      _remaining(0) { }
+
+MonotonicAllocator::~MonotonicAllocator() {
+    release();
+}
+
+void* MonotonicAllocator::allocate(size_t size) {
+    size = align(size);
+    if (size > _remaining) {
+        // Oversized requests get a block of their own, so that the current block can continue
+        // to serve small requests.
+        if (size > _block_size / 4) {
+            void* block = _upstream->allocate(size);
+            _blocks.push_back(make_pair(block, size));
+            return block;
+        }
+        _next = static_cast<char*>(_upstream->allocate(_block_size));
+        _remaining = _block_size;
+        _blocks.push_back(make_pair(static_cast<void*>(_next), _block_size));
+    }
+    void* result = _next;
+    _next += size;
+    _remaining -= size;
+    return result;
+}
+
+void MonotonicAllocator::deallocate(void* pointer, size_t size) { }
+
+void MonotonicAllocator::release() {
+    for (size_t i = 0; i < _blocks.size(); ++i) {
+        _upstream->deallocate(_blocks[i].first, _blocks[i].second);
+    }
+    _blocks.clear();
+    _next = NULL;
+    _remaining = 0;
+}
+
+void* Allocated::operator new(size_t size) {
+    return operator new(size, pool_allocator());
+}
+
+void* Allocated::operator new(size_t size, Allocator* allocator) {
+    if (allocator == NULL) {
+        allocator = pool_allocator();
+    }
+    size += sizeof(AllocatedHeader);
+    AllocatedHeader* header = static_cast<AllocatedHeader*>(allocator->allocate(size));
+    header->block.allocator = allocator;
+    header->block.size = size;
+    return header + 1;
+}
+
+void Allocated::operator delete(void* pointer) {
+    if (pointer == NULL) {
+        return;
+    }
+    AllocatedHeader* header = static_cast<AllocatedHeader*>(pointer) - 1;
+    header->block.allocator->deallocate(header, header->block.size);
+}
+
+void Allocated::operator delete(void* pointer, Allocator* allocator) {
+    operator delete(pointer);
+}
+
+}  // namespace rgos
@@ -0,0 +1,147 @@
+// Copyright (c) 2009 Chris Pickel <sfiera@gmail.com>
+//
+// This file is part of librgos, a free software project.  You can redistribute it and/or modify it
+// under the terms of the MIT License.
+
+#include "rgos/Allocator.hpp"
+
+#include <pthread.h>
+#include <stdint.h>
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <sfz/sfz.hpp>
+#include "rgos/Json.hpp"
+#include "rgos/Serialize.hpp"
+
+using sfz::String;
+using std::make_pair;
+using std::vector;
+using testing::Eq;
+using testing::Gt;
+
+namespace rgos {
+namespace {
+
+// Forwards to the default allocator, counting blocks that are still live.
+class CountingAllocator : public Allocator {
+  public:
+    CountingAllocator() : live(0), total(0) { }
+
+    virtual void* allocate(size_t size) {
+        ++live;
+        ++total;
+        return default_allocator()->allocate(size);
+    }
+
+    virtual void deallocate(void* pointer, size_t size) {
+        --live;
+        default_allocator()->deallocate(pointer, size);
+    }
+
+    int live;
+    int total;
+};
+
+typedef ::testing::Test AllocatorTest;
+
+TEST_F(AllocatorTest, ScalarTest) {
+    CountingAllocator allocator;
+    {
+        Json number = Json::number(1.0, &allocator);
+        Json copy = number;
+        EXPECT_THAT(allocator.live, Eq(1));
+        Json::bool_(true, &allocator);
+        EXPECT_THAT(allocator.total, Eq(2));
+        EXPECT_THAT(String(copy), Eq(String(Json::number(1.0))));
+    }
+    EXPECT_THAT(allocator.live, Eq(0));
+}
+
+TEST_F(AllocatorTest, StringMapTest) {
+    CountingAllocator allocator;
+    {
+        StringMap<int> map(&allocator);
+        map.insert(make_pair("one", 1));
+        map["two"] = 2;
+        EXPECT_THAT(allocator.live, Gt(0));
+        EXPECT_THAT(map.allocator(), Eq<Allocator*>(&allocator));
+
+        StringMap<int> copy(map);
+        EXPECT_THAT(copy.allocator(), Eq(pool_allocator()));
+    }
+    EXPECT_THAT(allocator.live, Eq(0));
+}
+
+TEST_F(AllocatorTest, ObjectTest) {
+    CountingAllocator allocator;
+    StringMap<Json> o;
+    o.insert(make_pair("one", Json::number(1.0)));
+    {
+        Json object = Json::object(o, &allocator);
+        // The object node, plus one entry and one tree node for its member.
+        EXPECT_THAT(allocator.live, Eq(3));
+    }
+    EXPECT_THAT(allocator.live, Eq(0));
+}
+
+TEST_F(AllocatorTest, MonotonicTest) {
+    CountingAllocator upstream;
+    MonotonicAllocator allocator(1024, &upstream);
+    for (int i = 0; i < 100; ++i) {
+        void* p = allocator.allocate(1 + i % 24);
+        EXPECT_THAT(reinterpret_cast<uintptr_t>(p) % 16, Eq(0u));
+    }
+    EXPECT_THAT(upstream.live, Gt(1));
+
+    allocator.release();
+    EXPECT_THAT(upstream.live, Eq(0));
+
+    {
+        vector<Json> a;
+        a.push_back(Json::number(1.0, &allocator));
+        a.push_back(Json::string("two", &allocator));
+        EXPECT_THAT(String(Json::array(a, &allocator)), Eq(String(Json::array(a))));
+    }
+    allocator.release();
+    EXPECT_THAT(upstream.live, Eq(0));
+}
+
+TEST_F(AllocatorTest, PoolReuseTest) {
+    Allocator* pool = pool_allocator();
+    void* first = pool->allocate(40);
+    pool->deallocate(first, 40);
+    void* second = pool->allocate(33);  // Same size class as 40.
+    EXPECT_THAT(second, Eq(first));
+    pool->deallocate(second, 33);
+
+    void* large = pool->allocate(4096);
+    EXPECT_THAT(reinterpret_cast<uintptr_t>(large) % 16, Eq(0u));
+    pool->deallocate(large, 4096);
+}
+
+void* build_numbers(void* arg) {
+    vector<Json>* numbers = static_cast<vector<Json>*>(arg);
+    for (int i = 0; i < 1000; ++i) {
+        numbers->push_back(Json::number(i));
+    }
+    return NULL;
+}
+
+// Nodes allocated on one thread and released on another go back to the pool without error.
+TEST_F(AllocatorTest, PoolThreadTest) {
+    vector<Json> numbers[4];
+    pthread_t threads[4];
+    for (int i = 0; i < 4; ++i) {
+        pthread_create(&threads[i], NULL, build_numbers, &numbers[i]);
+    }
+    for (int i = 0; i < 4; ++i) {
+        pthread_join(threads[i], NULL);
+    }
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_THAT(String(numbers[i][999]), Eq(String(Json::number(999))));
+        numbers[i].clear();
+    }
+}
+
+}  // namespace
+}  // namespace rgos
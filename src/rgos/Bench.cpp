@@ -0,0 +1,247 @@
+// Copyright (c) 2009 Chris Pickel <sfiera@gmail.com>
+//
+// This file is part of librgos, a free software project.  You can redistribute it and/or modify it
+// under the terms of the MIT License.
+
+#include "Bench.hpp"
+
+#include <new>
+#include <stdio.h>
+#include <string.h>
+#include <sys/time.h>
+#include <vector>
+#include <sfz/sfz.hpp>
+
+using sfz::String;
+using sfz::StringSlice;
+using std::vector;
+
+namespace {
+
+// Allocation accounting.  The benchmark binary replaces the global operator new and delete so
+// that every heap allocation made by librgos (and libsfz, and the standard library on its
+// behalf) is counted.  Each block carries a header recording its size, so that live and peak
+// usage can be tracked as well.
+struct AllocationCounters {
+    uint64_t allocations;
+    uint64_t bytes;
+    int64_t live_bytes;
+    int64_t peak_bytes;
+};
+
+AllocationCounters counters;
+
+const size_t kHeaderSize = 16;
+
+void* counted_malloc(size_t size) {
+    char* block = reinterpret_cast<char*>(malloc(kHeaderSize + size));
+    if (block == NULL) {
+        throw std::bad_alloc();
+    }
+    memcpy(block, &size, sizeof(size));
+    ++counters.allocations;
+    counters.bytes += size;
+    counters.live_bytes += size;
+    if (counters.live_bytes > counters.peak_bytes) {
+        counters.peak_bytes = counters.live_bytes;
+    }
+    return block + kHeaderSize;
+}
+
+void counted_free(void* pointer) {
+    if (pointer == NULL) {
+        return;
+    }
+    char* block = reinterpret_cast<char*>(pointer) - kHeaderSize;
+    size_t size;
+    memcpy(&size, block, sizeof(size));
+    counters.live_bytes -= size;
+    free(block);
+}
+
+int64_t now_usecs() {
+    timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec * 1000000ll + tv.tv_usec;
+}
+
+struct Benchmark {
+    const char* name;
+    rgos::BenchFunction function;
+};
+
+vector<Benchmark>& benchmarks() {
+    static vector<Benchmark>* result = new vector<Benchmark>;
+    return *result;
+}
+
+// A tiny linear congruential generator, so that corpora do not depend on the platform's rand().
+class Random {
+  public:
+    Random() : _state(0x2545F491) { }
+    uint32_t next() {
+        _state = _state * 1664525u + 1013904223u;
+        return _state >> 8;
+    }
+
+  private:
+    uint32_t _state;
+};
+
+const char kWords[] =
+    "lorem ipsum dolor sit amet consectetur adipiscing elit sed do eiusmod tempor incididunt ut "
+    "labore et dolore magna aliqua ut enim ad minim veniam quis nostrud exercitation ullamco ";
+
+}  // namespace
+
+void* operator new(size_t size) throw(std::bad_alloc) {
+    return counted_malloc(size);
+}
+
+void* operator new[](size_t size) throw(std::bad_alloc) {
+    return counted_malloc(size);
+}
+
+void operator delete(void* pointer) throw() {
+    counted_free(pointer);
+}
+
+void operator delete[](void* pointer) throw() {
+    counted_free(pointer);
+}
+
+namespace rgos {
+
+BenchState::BenchState(size_t iterations)
+    : iterations(iterations),
+      bytes(0),
+      items(0),
+      _start_usecs(0),
+      _start_live_bytes(0) { }
+
+void BenchState::start() {
+    counters.allocations = 0;
+    counters.bytes = 0;
+    counters.peak_bytes = counters.live_bytes;
+    _start_live_bytes = counters.live_bytes;
+    _start_usecs = now_usecs();
+}
+
+BenchRegistration::BenchRegistration(const char* name, BenchFunction function) {
+    Benchmark benchmark = { name, function };
+    benchmarks().push_back(benchmark);
+}
+
+class BenchRunner {
+  public:
+    // Runs `benchmark` with increasing iteration counts until one run takes at least
+    // kMinimumUsecs, then reports the figures from that run.
+    static void run(const Benchmark& benchmark) {
+        const int64_t kMinimumUsecs = 200000;
+        for (size_t iterations = 1; true; iterations *= 2) {
+            BenchState state(iterations);
+            state.start();
+            benchmark.function(&state);
+            int64_t usecs = now_usecs() - state._start_usecs;
+            if ((usecs < kMinimumUsecs) && (iterations < (1u << 30))) {
+                continue;
+            }
+
+            double ns_per_op = usecs * 1000.0 / iterations;
+            printf("%-32s %10zu %12.1f ns/op", benchmark.name, iterations, ns_per_op);
+            if (state.bytes > 0) {
+                printf(" %9.1f MB/s", (state.bytes * iterations) / (usecs + 1.0));
+            } else if (state.items > 0) {
+                printf(" %9.2f Mi/s", (state.items * iterations) / (usecs + 1.0));
+            } else {
+                printf(" %9s     ", "");
+            }
+            printf(" %10.1f allocs/op %12.1f B/op %12lld peak B\n",
+                    double(counters.allocations) / iterations,
+                    double(counters.bytes) / iterations,
+                    static_cast<long long>(counters.peak_bytes - state._start_live_bytes));
+            return;
+        }
+    }
+};
+
+Json number_corpus(size_t size) {
+    Random random;
+    vector<Json> records;
+    for (size_t i = 0; i < size; ++i) {
+        vector<Json> record;
+        for (int j = 0; j < 8; ++j) {
+            double value = int32_t(random.next()) / 1000.0;
+            record.push_back(Json::number(value));
+        }
+        record.push_back(Json::bool_(random.next() & 1));
+        records.push_back(Json::array(record));
+    }
+    return Json::array(records);
+}
+
+Json string_corpus(size_t size) {
+    Random random;
+    const size_t kWordsSize = sizeof(kWords) - 1;
+    vector<Json> records;
+    for (size_t i = 0; i < size; ++i) {
+        size_t start = random.next() % (kWordsSize / 2);
+        size_t length = 16 + (random.next() % (kWordsSize / 2 - 16));
+        String value(StringSlice(kWords).slice(start, length));
+        if ((i % 4) == 0) {
+            value.push("\n\t\"quoted\"");
+        }
+        records.push_back(Json::string(value));
+    }
+    return Json::array(records);
+}
+
+Json deep_corpus(size_t depth) {
+    Json result = Json::number(depth);
+    for (size_t i = 0; i < depth; ++i) {
+        vector<Json> level;
+        level.push_back(result);
+        result = Json::array(level);
+    }
+    return result;
+}
+
+Json wide_corpus(size_t size) {
+    Random random;
+    StringMap<Json> object;
+    for (size_t i = 0; i < size; ++i) {
+        String key(bench_key("key", i, 6));
+        if (random.next() & 1) {
+            object.insert(std::make_pair(StringSlice(key), Json::number(random.next())));
+        } else {
+            object.insert(std::make_pair(StringSlice(key), Json::string(key)));
+        }
+    }
+    return Json::object(object);
+}
+
+String bench_key(const StringSlice& prefix, size_t n, int width) {
+    char digits[32];
+    snprintf(digits, sizeof(digits), "%0*zu", width, n);
+    String result(prefix);
+    result.push(digits);
+    return result;
+}
+
+}  // namespace rgos
+
+// Usage: librgos-bench [FILTER]
+//
+// Runs every benchmark whose name contains FILTER (or all benchmarks, if FILTER is omitted).
+int main(int argc, char* const* argv) {
+    const char* filter = (argc > 1) ? argv[1] : "";
+    printf("%-32s %10s %17s %14s %20s %15s %17s\n",
+            "benchmark", "iterations", "time", "throughput", "allocations", "allocated",
+            "peak");
+    foreach (const Benchmark& benchmark, benchmarks()) {
+        if (strstr(benchmark.name, filter) != NULL) {
+            rgos::BenchRunner::run(benchmark);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,61 @@
+// Copyright (c) 2009 Chris Pickel <sfiera@gmail.com>
+//
+// This file is part of librgos, a free software project.  You can redistribute it and/or modify it
+// under the terms of the MIT License.
+
+#ifndef RGOS_BENCH_HPP_
+#define RGOS_BENCH_HPP_
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <rgos/Json.hpp>
+
+namespace rgos {
+
+// Passed to each benchmark.  The benchmark performs any setup it needs, calls start() once, and
+// then runs its measured operation `iterations` times.  Time and allocations before start() are
+// not counted.  If each iteration processes a known number of bytes (e.g. serialized output),
+// the benchmark may set `bytes` so that throughput is reported in MB/s.  Alternatively, it may
+// set `items` (e.g. records written) to report throughput in millions of items per second.
+class BenchState {
+  public:
+    explicit BenchState(size_t iterations);
+
+    void start();
+
+    const size_t iterations;
+    size_t bytes;
+    size_t items;
+
+  private:
+    friend class BenchRunner;
+
+    int64_t _start_usecs;
+    int64_t _start_live_bytes;
+};
+
+typedef void (*BenchFunction)(BenchState* state);
+
+class BenchRegistration {
+  public:
+    BenchRegistration(const char* name, BenchFunction function);
+};
+
+#define BENCHMARK(NAME) \
+    void NAME(::rgos::BenchState* state); \
+    ::rgos::BenchRegistration NAME ## _registration(#NAME, NAME); \
+    void NAME(::rgos::BenchState* state)
+
+// Deterministic synthetic corpora, built from a fixed seed so that every run measures the same
+// document.  Their shapes differ, as described beside each one.
+Json number_corpus(size_t size);  // [[1.5, -203, ...], ...]: mostly numbers.
+Json string_corpus(size_t size);  // ["lorem ipsum...", ...]: mostly long strings.
+Json deep_corpus(size_t depth);   // [[[[...]]]]: one chain of `depth` nested arrays.
+Json wide_corpus(size_t size);    // {"key0000": ..., ...}: one object with `size` keys.
+
+// Returns a deterministic key of the form "<prefix><n>", zero-padded to `width` digits.
+sfz::String bench_key(const sfz::StringSlice& prefix, size_t n, int width);
+
+}  // namespace rgos
+
+#endif  // RGOS_BENCH_HPP_
@@ -0,0 +1,33 @@
+// Copyright (c) 2009 Chris Pickel <sfiera@gmail.com>
+//
+// This file is part of librgos, a free software project.  You can redistribute it and/or modify it
+// under the terms of the MIT License.
+
+#include "rgos/ByteSink.hpp"
+
+#include <errno.h>
+#include <unistd.h>
+
+namespace rgos {
+
+ByteSink::~ByteSink() { }
+
+FdSink::FdSink(int fd)
+    : _fd(fd) { }
+
+bool FdSink::write(const char* data, size_t size, size_t* written) {
+    while (true) {
+        ssize_t result = ::write(_fd, data, size);
+        if (result >= 0) {
+            *written = result;
+            return true;
+        } else if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+            *written = 0;
+            return true;
+        } else if (errno != EINTR) {
+            return false;
+        }
+    }
+}
+
+}  // namespace rgos
@@ -0,0 +1,62 @@
+// Copyright (c) 2009 Chris Pickel <sfiera@gmail.com>
+//
+// This file is part of librgos, a free software project.  You can redistribute it and/or modify it
+// under the terms of the MIT License.
+
+#include "rgos/ByteSink.hpp"
+
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <vector>
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+using std::vector;
+using testing::Eq;
+using testing::Gt;
+using testing::Lt;
+
+namespace rgos {
+namespace {
+
+typedef ::testing::Test ByteSinkTest;
+
+TEST_F(ByteSinkTest, FdSinkTest) {
+    int fds[2];
+    ASSERT_THAT(pipe(fds), Eq(0));
+    ASSERT_THAT(fcntl(fds[1], F_SETFL, fcntl(fds[1], F_GETFL) | O_NONBLOCK), Eq(0));
+    FdSink sink(fds[1]);
+
+    // Fill the pipe.
+    const vector<char> data(1 << 20, 'x');
+    size_t total = 0;
+    size_t written;
+    ASSERT_TRUE(sink.write(&data[0], data.size(), &written));
+    ASSERT_THAT(written, Gt(0u));
+    ASSERT_THAT(written, Lt(data.size()));
+    total += written;
+    ASSERT_TRUE(sink.write(&data[0], data.size(), &written));
+    EXPECT_THAT(written, Eq(0u));
+
+    // Drain it, and there is room again.
+    vector<char> buffer(total);
+    size_t read_total = 0;
+    while (read_total < total) {
+        ssize_t result = read(fds[0], &buffer[0], buffer.size());
+        ASSERT_THAT(result, Gt(0));
+        read_total += result;
+    }
+    ASSERT_TRUE(sink.write(&data[0], 10, &written));
+    EXPECT_THAT(written, Eq(10u));
+
+    // Writing to a pipe with no reader fails.
+    void (*old_handler)(int) = signal(SIGPIPE, SIG_IGN);
+    close(fds[0]);
+    EXPECT_FALSE(sink.write(&data[0], 10, &written));
+    signal(SIGPIPE, old_handler);
+    close(fds[1]);
+}
+
+}  // namespace
+}  // namespace rgos
@@ -0,0 +1,123 @@
+// Copyright (c) 2009 Chris Pickel <sfiera@gmail.com>
+//
+// This file is part of librgos, a free software project.  You can redistribute it and/or modify it
+// under the terms of the MIT License.
+
+#include "rgos/Interner.hpp"
+
+#include <string.h>
+#include <sfz/sfz.hpp>
+#include "rgos/JsonVisitor.hpp"
+#include "JsonContents.hpp"
+
+using sfz::PrintItem;
+using sfz::StringSlice;
+using std::make_pair;
+using std::multimap;
+using std::vector;
+
+namespace rgos {
+
+namespace {
+
+// NaN is unequal to itself, but a NaN with the same bits is the same value for interning: without
+// this, every NaN interned would be held again.
+bool same_nan(const Json& x, const Json& y) {
+    JsonContents x_contents(x);
+    JsonContents y_contents(y);
+    return x_contents.is_number && y_contents.is_number
+        && (x_contents.number != x_contents.number) && (y_contents.number != y_contents.number)
+        && (memcmp(&x_contents.number, &y_contents.number, sizeof(double)) == 0);
+}
+
+}  // namespace
+
+// Rebuilds a container that is not yet held from its interned children.
+class InternVisitor : public JsonVisitor {
+  public:
+    InternVisitor(JsonInterner* interner, Json* result)
+        : _interner(interner),
+          _result(result) { }
+
+    virtual void visit_object(const StringMap<Json>& value) { *_result = _interner->object(value); }
+    virtual void visit_array(const vector<Json>& value) { *_result = _interner->array(value); }
+
+    // Scalars have no children, so the original node can be held as-is.
+    virtual void visit_string(const StringSlice& value) { *_result = _interner->hold(*_result); }
+    virtual void visit_number(double value) { *_result = _interner->hold(*_result); }
+    virtual void visit_bool(bool value) { *_result = _interner->hold(*_result); }
+    virtual void visit_null() { *_result = _interner->hold(*_result); }
+
+  private:
+    JsonInterner* const _interner;
+    Json* const _result;
+
+    DISALLOW_COPY_AND_ASSIGN(InternVisitor);
+};
+
+JsonInterner::JsonInterner(Allocator* allocator)
+    : _allocator(allocator) { }
+
+// The children are interned first, and the node is built once, from the interned children.
+Json JsonInterner::object(const StringMap<Json>& value) {
+    StringMap<Json> members(_allocator);
+    foreach (const StringMap<Json>::value_type& item, value) {
+        members.insert(make_pair(item.first, intern(item.second)));
+    }
+    return hold(Json::adopt_object(&members, _allocator));
+}
+
+Json JsonInterner::array(const vector<Json>& value) {
+    vector<Json> elements;
+    elements.reserve(value.size());
+    foreach (const Json& item, value) {
+        elements.push_back(intern(item));
+    }
+    return hold(Json::adopt_array(&elements, _allocator));
+}
+
+Json JsonInterner::string(const PrintItem& value) {
+    return hold(Json::string(value, _allocator));
+}
+
+Json JsonInterner::number(double value) {
+    return hold(Json::number(value, _allocator));
+}
+
+Json JsonInterner::bool_(bool value) {
+    return hold(Json::bool_(value, _allocator));
+}
+
+Json JsonInterner::intern(const Json& value) {
+    // An equal value that is already held has interned children, so it can be returned without
+    // looking at `value`'s children at all.
+    const Json* held = find(value);
+    if (held) {
+        return *held;
+    }
+    Json result = value;
+    InternVisitor visitor(this, &result);
+    value.accept(&visitor);
+    return result;
+}
+
+Json JsonInterner::hold(const Json& value) {
+    const Json* held = find(value);
+    if (held) {
+        return *held;
+    }
+    return _table.insert(make_pair(value.hash(), value))->second;
+}
+
+const Json* JsonInterner::find(const Json& value) const {
+    typedef multimap<size_t, Json>::const_iterator iterator;
+    std::pair<iterator, iterator> range = _table.equal_range(value.hash());
+    for (iterator it = range.first; it != range.second; ++it) {
+        if ((it->second == value) || same_nan(it->second, value)) {
+            return &it->second;
+        }
+    }
+    return NULL;
+}
+
+}  // namespace rgos
@@ -0,0 +1,138 @@
+// Copyright (c) 2009 Chris Pickel <sfiera@gmail.com>
+//
+// This file is part of librgos, a free software project.  You can redistribute it and/or modify it
+// under the terms of the MIT License.
+
+#include "rgos/Interner.hpp"
+
+#include <math.h>
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <sfz/sfz.hpp>
+#include "rgos/Json.hpp"
+#include "rgos/JsonVisitor.hpp"
+
+using sfz::StringSlice;
+using std::make_pair;
+using std::vector;
+using testing::Eq;
+using testing::Ne;
+
+namespace rgos {
+namespace {
+
+// Records the address of the vector held by an array node, so that tests can check whether two
+// Json values share a node.
+class ArrayAddress : public JsonDefaultVisitor {
+  public:
+    ArrayAddress() : address(NULL) { }
+    virtual void visit_array(const vector<Json>& value) { address = &value; }
+    virtual void visit_default(const char* type) { }
+    const vector<Json>* address;
+};
+
+const vector<Json>* array_address(const Json& json) {
+    ArrayAddress visitor;
+    json.accept(&visitor);
+    return visitor.address;
+}
+
+// Forwards to the default allocator, counting allocations.
+class CountingAllocator : public Allocator {
+  public:
+    CountingAllocator() : total(0) { }
+
+    virtual void* allocate(size_t size) {
+        ++total;
+        return default_allocator()->allocate(size);
+    }
+
+    virtual void deallocate(void* pointer, size_t size) {
+        default_allocator()->deallocate(pointer, size);
+    }
+
+    int total;
+};
+
+Json make_track(JsonInterner* interner, const StringSlice& title, double length) {
+    StringMap<Json> track;
+    track.insert(make_pair("title", Json::string(title)));
+    track.insert(make_pair("length", Json::number(length)));
+    vector<Json> tags;
+    tags.push_back(Json::string("rock"));
+    tags.push_back(Json::string("indie"));
+    track.insert(make_pair("tags", Json::array(tags)));
+    return interner->object(track);
+}
+
+typedef ::testing::Test InternerTest;
+
+TEST_F(InternerTest, ScalarTest) {
+    JsonInterner interner;
+    Json one = interner.number(1.0);
+    EXPECT_THAT(interner.number(1.0), Eq(one));
+    EXPECT_THAT(interner.size(), Eq(1u));
+    interner.string("one");
+    interner.string("one");
+    EXPECT_THAT(interner.size(), Eq(2u));
+}
+
+TEST_F(InternerTest, SubtreeTest) {
+    JsonInterner interner;
+    Json a = make_track(&interner, "Hey Everyone", 151);
+    Json b = make_track(&interner, "Watch This!", 213);
+    Json c = make_track(&interner, "Hey Everyone", 151);
+    EXPECT_THAT(c, Eq(a));
+    EXPECT_THAT(b, Ne(a));
+
+    // Both tracks' "tags" arrays were built separately, but share one node once interned.
+    vector<Json> tags;
+    tags.push_back(Json::string("rock"));
+    tags.push_back(Json::string("indie"));
+    Json interned = interner.array(tags);
+    EXPECT_THAT(array_address(interned), Eq(array_address(interner.intern(Json::array(tags)))));
+    EXPECT_THAT(array_address(interned), Ne(array_address(Json::array(tags))));
+}
+
+TEST_F(InternerTest, NanTest) {
+    JsonInterner interner;
+    interner.number(NAN);
+    interner.number(NAN);
+    interner.intern(Json::number(NAN));
+    EXPECT_THAT(interner.size(), Eq(1u));
+
+    vector<Json> elements;
+    elements.push_back(Json::number(NAN));
+    Json array = interner.array(elements);
+    EXPECT_THAT(array_address(interner.array(elements)), Eq(array_address(array)));
+    EXPECT_THAT(interner.size(), Eq(2u));
+}
+
+TEST_F(InternerTest, SingleBuildTest) {
+    // On a miss, the array node is built once, from the interned elements.
+    CountingAllocator allocator;
+    JsonInterner interner(&allocator);
+    vector<Json> elements;
+    elements.push_back(Json::number(1.0));
+    elements.push_back(Json::string("two"));
+    Json array = interner.array(elements);
+    EXPECT_THAT(allocator.total, Eq(1));
+    EXPECT_THAT(interner.size(), Eq(3u));
+
+    // A hit returns the held node.
+    EXPECT_THAT(array_address(interner.array(elements)), Eq(array_address(array)));
+    EXPECT_THAT(interner.size(), Eq(3u));
+}
+
+TEST_F(InternerTest, ClearTest) {
+    JsonInterner interner;
+    interner.number(1.0);
+    interner.bool_(true);
+    interner.intern(Json());
+    EXPECT_THAT(interner.size(), Eq(3u));
+    interner.clear();
+    EXPECT_THAT(interner.size(), Eq(0u));
+}
+
+}  // namespace
+}  // namespace rgos
@@ -0,0 +1,215 @@
+// Copyright (c) 2009 Chris Pickel <sfiera@gmail.com>
+//
+// This file is part of librgos, a free software project.  You can redistribute it and/or modify it
+// under the terms of the MIT License.
+
+#include "rgos/Json.hpp"
+
+#include <vector>
+#include <sfz/sfz.hpp>
+#include "rgos/Interner.hpp"
+#include "rgos/JsonBuilder.hpp"
+#include "rgos/JsonWalker.hpp"
+#include "Bench.hpp"
+
+using sfz::String;
+using sfz::StringSlice;
+using std::make_pair;
+using std::vector;
+
+namespace rgos {
+namespace {
+
+BENCHMARK(JsonNumber) {
+    state->start();
+    for (size_t i = 0; i < state->iterations; ++i) {
+        Json::number(i);
+    }
+}
+
+BENCHMARK(JsonNumberHeap) {
+    Allocator* heap = default_allocator();
+    state->start();
+    for (size_t i = 0; i < state->iterations; ++i) {
+        Json::number(i, heap);
+    }
+}
+
+BENCHMARK(JsonBool) {
+    state->start();
+    for (size_t i = 0; i < state->iterations; ++i) {
+        Json::bool_(i & 1);
+    }
+}
+
+BENCHMARK(JsonString) {
+    state->start();
+    for (size_t i = 0; i < state->iterations; ++i) {
+        Json::string("The Greater Than Symbol & The Hash");
+    }
+}
+
+BENCHMARK(JsonArray100) {
+    vector<Json> elements;
+    for (int i = 0; i < 100; ++i) {
+        elements.push_back(Json::number(i));
+    }
+    state->start();
+    for (size_t i = 0; i < state->iterations; ++i) {
+        Json::array(elements);
+    }
+}
+
+BENCHMARK(JsonObject100) {
+    StringMap<Json> members;
+    for (int i = 0; i < 100; ++i) {
+        members.insert(make_pair(StringSlice(bench_key("key", i, 3)), Json::number(i)));
+    }
+    state->start();
+    for (size_t i = 0; i < state->iterations; ++i) {
+        Json::object(members);
+    }
+}
+
+// A response of 1000 records, assembled bottom-up from copied containers.
+BENCHMARK(JsonResponseByHand) {
+    state->start();
+    for (size_t i = 0; i < state->iterations; ++i) {
+        vector<Json> records;
+        for (int j = 0; j < 1000; ++j) {
+            StringMap<Json> record;
+            record["id"] = Json::number(j);
+            record["name"] = Json::string("record");
+            records.push_back(Json::object(record));
+        }
+        StringMap<Json> response;
+        response["count"] = Json::number(records.size());
+        response["records"] = Json::array(records);
+        Json::object(response);
+    }
+}
+
+// The same response, assembled with JsonBuilder.
+BENCHMARK(JsonResponseBuilder) {
+    state->start();
+    for (size_t i = 0; i < state->iterations; ++i) {
+        JsonBuilder builder;
+        builder.reserve("/records", 1000);
+        for (int j = 0; j < 1000; ++j) {
+            JsonBuilder record;
+            record.set("/id", Json::number(j));
+            record.set("/name", Json::string("record"));
+            builder.append("/records", record.freeze());
+        }
+        builder.set("/count", Json::number(1000));
+        builder.freeze();
+    }
+}
+
+BENCHMARK(JsonBuildNumberCorpus) {
+    state->start();
+    for (size_t i = 0; i < state->iterations; ++i) {
+        number_corpus(1000);
+    }
+}
+
+BENCHMARK(JsonBuildStringCorpus) {
+    state->start();
+    for (size_t i = 0; i < state->iterations; ++i) {
+        string_corpus(1000);
+    }
+}
+
+BENCHMARK(JsonBuildDeepCorpus) {
+    state->start();
+    for (size_t i = 0; i < state->iterations; ++i) {
+        deep_corpus(1000);
+    }
+}
+
+BENCHMARK(JsonBuildWideCorpus) {
+    state->start();
+    for (size_t i = 0; i < state->iterations; ++i) {
+        wide_corpus(1000);
+    }
+}
+
+BENCHMARK(JsonEqualShared) {
+    Json x = string_corpus(1000);
+    Json y = x;
+    state->start();
+    for (size_t i = 0; i < state->iterations; ++i) {
+        x == y;
+    }
+}
+
+BENCHMARK(JsonEqualStructural) {
+    Json x = string_corpus(1000);
+    Json y = string_corpus(1000);
+    state->start();
+    for (size_t i = 0; i < state->iterations; ++i) {
+        x == y;
+    }
+}
+
+BENCHMARK(JsonInternNumberCorpus) {
+    Json corpus = number_corpus(1000);
+    state->start();
+    for (size_t i = 0; i < state->iterations; ++i) {
+        JsonInterner interner;
+        interner.intern(corpus);
+    }
+}
+
+class NullEventVisitor : public JsonEventVisitor {
+  public:
+    virtual Action begin_object(const StringMap<Json>& value) { return CONTINUE; }
+    virtual Action object_key(const StringSlice& key, size_t index) { return CONTINUE; }
+    virtual Action end_object(const StringMap<Json>& value) { return CONTINUE; }
+    virtual Action begin_array(const vector<Json>& value) { return CONTINUE; }
+    virtual Action array_element(size_t index) { return CONTINUE; }
+    virtual Action end_array(const vector<Json>& value) { return CONTINUE; }
+    virtual Action visit_string(const StringSlice& value) { return CONTINUE; }
+    virtual Action visit_number(double value) { return CONTINUE; }
+    virtual Action visit_bool(bool value) { return CONTINUE; }
+    virtual Action visit_null() { return CONTINUE; }
+};
+
+void bench_walk(BenchState* state, const Json& json) {
+    NullEventVisitor visitor;
+    state->start();
+    for (size_t i = 0; i < state->iterations; ++i) {
+        walk(json, &visitor);
+    }
+}
+
+BENCHMARK(WalkDeep100k) { bench_walk(state, deep_corpus(100000)); }
+BENCHMARK(WalkWideShallow100k) { bench_walk(state, wide_corpus(100000)); }
+BENCHMARK(WalkNumberCorpus) { bench_walk(state, number_corpus(1000)); }
+
+// Stops at the first number equal to `target`.
+class FindNumberVisitor : public NullEventVisitor {
+  public:
+    explicit FindNumberVisitor(double target) : _target(target) { }
+    virtual Action visit_number(double value) { return (value == _target) ? STOP : CONTINUE; }
+
+  private:
+    const double _target;
+};
+
+// The match is near the front of a million-element array, so the walk ends almost at once.
+BENCHMARK(FindFirstNumber1M) {
+    vector<Json> elements;
+    for (int i = 0; i < 1000000; ++i) {
+        elements.push_back(Json::number(i));
+    }
+    const Json json = Json::array(elements);
+    FindNumberVisitor visitor(100);
+    state->start();
+    for (size_t i = 0; i < state->iterations; ++i) {
+        walk(json, &visitor);
+    }
+}
+
+}  // namespace
+}  // namespace rgos
@@ -6,11 +6,16 @@
 #include "rgos/Json.hpp"
 
 #include <math.h>
+#include <stdint.h>
+#include <string.h>
 #include <sfz/sfz.hpp>
 #include "rgos/JsonVisitor.hpp"
 #include "rgos/Serialize.hpp"
+#include "rgos/Stats.hpp"
 
 using sfz::ReferenceCounted;
+using sfz::Rune;
+using sfz::StringSlice;
 using sfz::scoped_ptr;
 using sfz::quote;
 using std::map;
@@ -18,22 +23,169 @@ using std::vector;
 
 namespace rgos {
 
-class Json::Value : public ReferenceCounted {
+namespace {
+
+const uint64_t kNullHash = 0x6e756c6cull;
+const uint64_t kTrueHash = 0x74727565ull;
+const uint64_t kFalseHash = 0x66616c7365ull;
+const uint64_t kArraySeed = 0x5b5dull;
+const uint64_t kObjectSeed = 0x7b7dull;
+
+// Finalizer from MurmurHash3: spreads every input bit over every output bit.
+uint64_t mix(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+uint64_t combine(uint64_t seed, uint64_t value) {
+    return seed ^ (value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2));
+}
+
+// FNV-1a over the string's code points.
+uint64_t hash_string(const StringSlice& value) {
+    uint64_t h = 0xcbf29ce484222325ull;
+    foreach (Rune r, value) {
+        h = (h ^ r) * 0x100000001b3ull;
+    }
+    return mix(h);
+}
+
+uint64_t hash_number(double value) {
+    if (value == 0) {
+        value = 0;  // -0.0 == 0.0, so they must hash alike.
+    }
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return mix(bits);
+}
+
+// The children waiting to be released by release_children() on this thread, or NULL if it isn't
+// running.
+__thread vector<Json>* pending_children = NULL;
+
+// Drops the references in `children`, leaving it empty.  Destroying a node only queues its
+// children, and the outermost call releases the queue one value at a time, so destroying a
+// deeply nested value doesn't take a stack frame per level.
+void release_children(vector<Json>* children) {
+    if (pending_children) {
+        pending_children->insert(pending_children->end(), children->begin(), children->end());
+        children->clear();
+        return;
+    }
+    vector<Json> pending;
+    pending.swap(*children);
+    pending_children = &pending;
+    while (!pending.empty()) {
+        // If this is the last reference, the child is destroyed when `child` goes out of scope,
+        // and its own children are appended to `pending`.
+        Json child = pending.back();
+        pending.pop_back();
+    }
+    pending_children = NULL;
+}
+
+}  // namespace
+
+class Json::Value : public ReferenceCounted, public Allocated {
   public:
+    enum Type {
+        OBJECT,
+        ARRAY,
+        STRING,
+        NUMBER,
+        BOOL
+    };
+
+    Value(Type type, uint64_t hash)
+        : _type(type),
+          _hash(hash),
+          _serialized(NULL) { }
+
+    virtual ~Value() {
+        delete _serialized;
+    }
+
     virtual void accept(JsonVisitor* visitor) const = 0;
+
+    // Only called when `other` has the same type and hash as this.
+    virtual bool equals(const Value& other) const = 0;
+
+    Type type() const { return _type; }
+    uint64_t hash() const { return _hash; }
+
+    const sfz::String* serialized() const { return _serialized; }
+    void set_serialized(sfz::String* serialized) const {
+        if (!__sync_bool_compare_and_swap(&_serialized, NULL, serialized)) {
+            delete serialized;
+        }
+    }
+
+  protected:
+    const Type _type;
+    uint64_t _hash;
+
+  private:
+    // Not part of the value: set at most once, by memoize().
+    mutable sfz::String* volatile _serialized;
 };
 
 class Json::Object : public Json::Value {
   public:
-    Object(const StringMap<Json>& value)
-        : _value(value) { }
+    Object(const StringMap<Json>& value, Allocator* allocator)
+        : Value(OBJECT, hash_members(value)),
+          _value(value, allocator) { }
+
+    explicit Object(StringMap<Json>* value)
+        : Value(OBJECT, 0),
+          _value(value->allocator()) {
+        _value.swap(*value);
+        _hash = hash_members(_value);
+    }
+
+    virtual ~Object() {
+        vector<Json> children;
+        children.reserve(_value.size());
+        for (StringMap<Json>::iterator it = _value.begin(); it != _value.end(); ++it) {
+            children.push_back(it->second);
+            it->second = Json();
+        }
+        release_children(&children);
+    }
 
     virtual void accept(JsonVisitor* visitor) const {
         visitor->visit_object(_value);
     }
 
+    virtual bool equals(const Value& other) const {
+        const StringMap<Json>& x = _value;
+        const StringMap<Json>& y = static_cast<const Object&>(other)._value;
+        if (x.size() != y.size()) {
+            return false;
+        }
+        for (StringMap<Json>::const_iterator it = x.begin(), jt = y.begin(); it != x.end();
+                ++it, ++jt) {
+            if ((it->first != jt->first) || (it->second != jt->second)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
   private:
-    const StringMap<Json> _value;
+    static uint64_t hash_members(const StringMap<Json>& value) {
+        uint64_t h = kObjectSeed;
+        foreach (const StringMap<Json>::value_type& item, value) {
+            h = combine(h, hash_string(item.first));
+            h = combine(h, item.second.hash());
+        }
+        return h;
+    }
+
+    StringMap<Json> _value;  // Only modified by the adopting constructor and the destructor.
 
     DISALLOW_COPY_AND_ASSIGN(Object);
 };
@@ -41,14 +193,37 @@ class Json::Object : public Json::Value {
 class Json::Array : public Json::Value {
   public:
     Array(const vector<Json>& value)
-        : _value(value) { }
+        : Value(ARRAY, hash_elements(value)),
+          _value(value) { }
+
+    explicit Array(vector<Json>* value)
+        : Value(ARRAY, 0) {
+        _value.swap(*value);
+        _hash = hash_elements(_value);
+    }
+
+    virtual ~Array() {
+        release_children(&_value);
+    }
 
     virtual void accept(JsonVisitor* visitor) const {
         visitor->visit_array(_value);
     }
 
+    virtual bool equals(const Value& other) const {
+        return _value == static_cast<const Array&>(other)._value;
+    }
+
   private:
-    const vector<Json> _value;
+    static uint64_t hash_elements(const vector<Json>& value) {
+        uint64_t h = kArraySeed;
+        foreach (const Json& item, value) {
+            h = combine(h, item.hash());
+        }
+        return h;
+    }
+
+    vector<Json> _value;  // Only modified by the adopting constructor and the destructor.
 
     DISALLOW_COPY_AND_ASSIGN(Array);
 };
@@ -56,12 +231,19 @@ class Json::Array : public Json::Value {
 class Json::String : public Json::Value {
   public:
     explicit String(const sfz::PrintItem& s)
-        : _value(s) { }
+        : Value(STRING, 0),
+          _value(s) {
+        _hash = hash_string(_value);
+    }
 
     virtual void accept(JsonVisitor* visitor) const {
         visitor->visit_string(_value);
     }
 
+    virtual bool equals(const Value& other) const {
+        return _value == static_cast<const String&>(other)._value;
+    }
+
   private:
     const sfz::String _value;
 
@@ -71,12 +253,17 @@ class Json::String : public Json::Value {
 class Json::Number : public Json::Value {
   public:
     explicit Number(double value)
-        : _value(value) { }
+        : Value(NUMBER, hash_number(value)),
+          _value(value) { }
 
     virtual void accept(JsonVisitor* visitor) const {
         visitor->visit_number(_value);
     }
 
+    virtual bool equals(const Value& other) const {
+        return _value == static_cast<const Number&>(other)._value;
+    }
+
   private:
     const double _value;
 
@@ -86,36 +273,73 @@ class Json::Number : public Json::Value {
 class Json::Bool : public Json::Value {
   public:
     explicit Bool(bool value)
-        : _value(value) { }
+        : Value(BOOL, value ? kTrueHash : kFalseHash),
+          _value(value) { }
 
     virtual void accept(JsonVisitor* visitor) const {
         visitor->visit_bool(_value);
     }
 
+    virtual bool equals(const Value& other) const {
+        return _value == static_cast<const Bool&>(other)._value;
+    }
+
   private:
     const bool _value;
 
     DISALLOW_COPY_AND_ASSIGN(Bool);
 };
 
-Json Json::object(const StringMap<Json>& value) {
-    return Json(new Object(value));
+Json Json::object(const StringMap<Json>& value, Allocator* allocator) {
+    RGOS_STATS_ADD(allocations, 1);
+    RGOS_STATS_ADD(allocated_bytes, sizeof(Object));
+    return Json(new (allocator) Object(value, allocator));
 }
 
-Json Json::array(const vector<Json>& value) {
-    return Json(new Array(value));
+Json Json::array(const vector<Json>& value, Allocator* allocator) {
+    RGOS_STATS_ADD(allocations, 1);
+    RGOS_STATS_ADD(allocated_bytes, sizeof(Array));
+    return Json(new (allocator) Array(value));
 }
 
-Json Json::string(const sfz::PrintItem& value) {
-    return Json(new String(value));
+Json Json::adopt_object(StringMap<Json>* value, Allocator* allocator) {
+    RGOS_STATS_ADD(allocations, 1);
+    RGOS_STATS_ADD(allocated_bytes, sizeof(Object));
+    return Json(new (allocator) Object(value));
 }
 
-Json Json::number(double value) {
-    return Json(new Number(value));
+Json Json::adopt_array(vector<Json>* value, Allocator* allocator) {
+    RGOS_STATS_ADD(allocations, 1);
+    RGOS_STATS_ADD(allocated_bytes, sizeof(Array));
+    return Json(new (allocator) Array(value));
 }
 
-Json Json::bool_(bool value) {
-    return Json(new Bool(value));
+Json Json::string(const sfz::PrintItem& value, Allocator* allocator) {
+    RGOS_STATS_ADD(allocations, 1);
+    RGOS_STATS_ADD(allocated_bytes, sizeof(String));
+    return Json(new (allocator) String(value));
+}
+
+bool Json::string(const char* data, size_t size, Utf8Policy policy, Json* result,
+                  Allocator* allocator) {
+    sfz::String decoded;
+    if (!decode_utf8(data, size, policy, &decoded)) {
+        return false;
+    }
+    *result = string(decoded, allocator);
+    return true;
+}
+
+Json Json::number(double value, Allocator* allocator) {
+    RGOS_STATS_ADD(allocations, 1);
+    RGOS_STATS_ADD(allocated_bytes, sizeof(Number));
+    return Json(new (allocator) Number(value));
+}
+
+Json Json::bool_(bool value, Allocator* allocator) {
+    RGOS_STATS_ADD(allocations, 1);
+    RGOS_STATS_ADD(allocated_bytes, sizeof(Bool));
+    return Json(new (allocator) Bool(value));
 }
 
 Json::Json() { }
@@ -141,4 +365,45 @@ void Json::accept(JsonVisitor* visitor) const {
     }
 }
 
+bool Json::operator==(const Json& other) const {
+    const Value* x = _value.get();
+    const Value* y = other._value.get();
+    if (x == y) {
+        return true;
+    } else if ((x == NULL) || (y == NULL)) {
+        return false;
+    } else if ((x->type() != y->type()) || (x->hash() != y->hash())) {
+        return false;
+    }
+    return x->equals(*y);
+}
+
+bool Json::operator!=(const Json& other) const {
+    return !(*this == other);
+}
+
+size_t Json::hash() const {
+    if (_value.get()) {
+        return _value->hash();
+    } else {
+        return kNullHash;
+    }
+}
+
+const sfz::String* Json::serialized() const {
+    if (_value.get()) {
+        return _value->serialized();
+    } else {
+        return NULL;
+    }
+}
+
+void Json::set_serialized(sfz::String* serialized) const {
+    if (_value.get()) {
+        _value->set_serialized(serialized);
+    } else {
+        delete serialized;
+    }
+}
+
 }  // namespace rgos
@@ -5,6 +5,7 @@
 
 #include "rgos/Json.hpp"
 
+#include <math.h>
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 #include <sfz/sfz.hpp>
@@ -16,6 +17,7 @@ using std::map;
 using std::vector;
 using testing::Eq;
 using testing::InSequence;
+using testing::Ne;
 using testing::StrictMock;
 
 namespace rgos {
@@ -233,5 +235,105 @@ TEST_F(JsonTest, ComplexObjectTest) {
     Json::object(album).accept(&visitor);
 }
 
+TEST_F(JsonTest, EqualityTest) {
+    EXPECT_TRUE(Json() == Json());
+    EXPECT_TRUE(Json::number(1.0) == Json::number(1.0));
+    EXPECT_TRUE(Json::number(0.0) == Json::number(-0.0));
+    EXPECT_TRUE(Json::string("one") == Json::string("one"));
+    EXPECT_TRUE(Json::bool_(false) == Json::bool_(false));
+
+    EXPECT_TRUE(Json() != Json::number(0.0));
+    EXPECT_TRUE(Json::number(1.0) != Json::number(2.0));
+    EXPECT_TRUE(Json::number(1.0) != Json::string("1"));
+    EXPECT_TRUE(Json::string("one") != Json::string("two"));
+    EXPECT_TRUE(Json::bool_(true) != Json::bool_(false));
+
+    const Json nan = Json::number(NAN);
+    EXPECT_TRUE(nan == nan);
+    EXPECT_TRUE(nan != Json::number(NAN));
+}
+
+TEST_F(JsonTest, ContainerEqualityTest) {
+    vector<Json> a;
+    a.push_back(Json::number(1.0));
+    a.push_back(Json::string("two"));
+    vector<Json> b(a);
+    EXPECT_TRUE(Json::array(a) == Json::array(b));
+    b.push_back(Json());
+    EXPECT_TRUE(Json::array(a) != Json::array(b));
+
+    StringMap<Json> x;
+    x.insert(make_pair("one", Json::number(1.0)));
+    x.insert(make_pair("array", Json::array(a)));
+    StringMap<Json> y;
+    y.insert(make_pair("array", Json::array(a)));
+    y.insert(make_pair("one", Json::number(1.0)));
+    EXPECT_TRUE(Json::object(x) == Json::object(y));
+    EXPECT_THAT(Json::object(x).hash(), Eq(Json::object(y).hash()));
+    y["one"] = Json::number(2.0);
+    EXPECT_TRUE(Json::object(x) != Json::object(y));
+}
+
+TEST_F(JsonTest, HashTest) {
+    EXPECT_THAT(Json::number(1.0).hash(), Eq(Json::number(1.0).hash()));
+    EXPECT_THAT(Json::number(0.0).hash(), Eq(Json::number(-0.0).hash()));
+    EXPECT_THAT(Json::string("one").hash(), Eq(Json::string("one").hash()));
+    EXPECT_THAT(Json::string("one").hash(), Ne(Json::string("two").hash()));
+    EXPECT_THAT(Json::bool_(true).hash(), Ne(Json::bool_(false).hash()));
+
+    vector<Json> ab;
+    ab.push_back(Json::string("a"));
+    ab.push_back(Json::string("b"));
+    vector<Json> ba;
+    ba.push_back(Json::string("b"));
+    ba.push_back(Json::string("a"));
+    EXPECT_THAT(Json::array(ab).hash(), Ne(Json::array(ba).hash()));
+}
+
+TEST_F(JsonTest, Utf8StringTest) {
+    sfz::String cafe("caf");
+    cafe.push(1, 0xe9);
+    Json json;
+    EXPECT_TRUE(Json::string("caf\xc3\xa9", 5, UTF8_REJECT, &json));
+    EXPECT_THAT(json, Eq(Json::string(cafe)));
+
+    // Ill-formed input is rejected, replaced or passed through.
+    const char ill_formed[] = "caf\xe9";
+    EXPECT_FALSE(Json::string(ill_formed, 4, UTF8_REJECT, &json));
+    EXPECT_THAT(json, Eq(Json::string(cafe)));
+    EXPECT_TRUE(Json::string(ill_formed, 4, UTF8_PASS_THROUGH, &json));
+    EXPECT_THAT(json, Eq(Json::string(cafe)));
+    sfz::String replaced("caf");
+    replaced.push(1, 0xfffd);
+    EXPECT_TRUE(Json::string(ill_formed, 4, UTF8_REPLACE, &json));
+    EXPECT_THAT(json, Eq(Json::string(replaced)));
+}
+
+// Tests that destroying a deeply nested value doesn't overflow the stack, and that subtrees which
+// are still referenced elsewhere survive it.
+TEST_F(JsonTest, DeepTeardownTest) {
+    const Json leaf = Json::string("leaf");
+    Json middle;
+    {
+        Json json = leaf;
+        for (int i = 0; i < 300000; ++i) {
+            if (i % 2) {
+                vector<Json> elements(1, json);
+                json = Json::array(elements);
+            } else {
+                StringMap<Json> members;
+                members["a"] = json;
+                json = Json::object(members);
+            }
+            if (i == 150000) {
+                middle = json;
+            }
+        }
+    }
+    EXPECT_THAT(middle.hash(), Ne(leaf.hash()));
+    middle = Json();
+    EXPECT_THAT(leaf, Eq(Json::string("leaf")));
+}
+
 }  // namespace
 }  // namespace rgos
@@ -0,0 +1,256 @@
+// Copyright (c) 2009 Chris Pickel <sfiera@gmail.com>
+//
+// This file is part of librgos, a free software project.  You can redistribute it and/or modify it
+// under the terms of the MIT License.
+
+#include "rgos/JsonBuilder.hpp"
+
+#include <map>
+#include <vector>
+#include <sfz/sfz.hpp>
+#include "rgos/StringMap.hpp"
+#include "JsonContents.hpp"
+#include "JsonPointer.hpp"
+
+using sfz::StringSlice;
+using sfz::linked_ptr;
+using std::map;
+using std::vector;
+
+namespace rgos {
+
+// A value in the document being built.  A VALUE node holds a Json as-is; OBJECT and ARRAY nodes
+// are open for editing.  The members and elements of an open container are stored as Json,
+// except for those that are open themselves: those are kept as child nodes, which override
+// `members` and `elements` (where they hold a placeholder, to keep the indices) until freeze().
+class JsonBuilder::Node {
+  public:
+    enum Kind {VALUE, OBJECT, ARRAY};
+
+    explicit Node(Allocator* allocator)
+        : _allocator(allocator),
+          _kind(VALUE),
+          _members(allocator),
+          _open_members(allocator) { }
+
+    Kind kind() const { return _kind; }
+
+    // Opens this node for editing, if it is not already.  A null value becomes an empty container
+    // of kind `missing`; an object or array is thawed by copying its top level.  Returns false if
+    // the value is neither, in which case nothing is changed.
+    bool open(Kind missing) {
+        if (_kind != VALUE) {
+            return true;
+        }
+        JsonContents contents(_value);
+        if (contents.object) {
+            StringMap<Json> members(*contents.object, _allocator);
+            _members.swap(members);
+            _kind = OBJECT;
+        } else if (contents.array) {
+            _elements = *contents.array;
+            _kind = ARRAY;
+        } else if (contents.is_null && (missing != VALUE)) {
+            _kind = missing;
+        } else {
+            return false;
+        }
+        _value = Json();
+        return true;
+    }
+
+    // Returns the child at `token`, opened for editing, or NULL if there is none and one cannot be
+    // created.  A missing child is created as an empty container of kind `missing`.  This node
+    // must already be open.
+    Node* child(const StringSlice& token, Kind missing) {
+        if (_kind == OBJECT) {
+            StringMap<linked_ptr<Node> >::iterator open_it = _open_members.find(token);
+            if (open_it != _open_members.end()) {
+                return open_it->second.get();
+            }
+            linked_ptr<Node> node(new Node(_allocator));
+            StringMap<Json>::iterator it = _members.find(token);
+            if (it != _members.end()) {
+                node->_value = it->second;
+            }
+            if (!node->open(missing)) {
+                return NULL;
+            }
+            _members.erase(token);
+            _open_members[token] = node;
+            return node.get();
+        } else if (_kind == ARRAY) {
+            size_t index;
+            if (!parse_array_index(token, _elements.size(), true, &index)) {
+                return NULL;
+            }
+            map<size_t, linked_ptr<Node> >::iterator open_it = _open_elements.find(index);
+            if (open_it != _open_elements.end()) {
+                return open_it->second.get();
+            }
+            linked_ptr<Node> node(new Node(_allocator));
+            if (index < _elements.size()) {
+                node->_value = _elements[index];
+            }
+            if (!node->open(missing)) {
+                return NULL;
+            }
+            if (index == _elements.size()) {
+                _elements.push_back(Json());
+            }
+            _open_elements[index] = node;
+            return node.get();
+        }
+        return NULL;
+    }
+
+    // Stores `value` at `token`.  This node must already be open.
+    bool set(const StringSlice& token, const Json& value) {
+        if (_kind == OBJECT) {
+            _open_members.erase(token);
+            _members[token] = value;
+            return true;
+        } else if (_kind == ARRAY) {
+            size_t index;
+            if (!parse_array_index(token, _elements.size(), true, &index)) {
+                return false;
+            }
+            if (index == _elements.size()) {
+                _elements.push_back(value);
+            } else {
+                _open_elements.erase(index);
+                _elements[index] = value;
+            }
+            return true;
+        }
+        return false;
+    }
+
+    void assign(const Json& value) {
+        _kind = VALUE;
+        _value = value;
+        _members.clear();
+        _open_members.clear();
+        _elements.clear();
+        _open_elements.clear();
+    }
+
+    void append(const Json& value) {
+        _elements.push_back(value);
+    }
+
+    void reserve(size_t capacity) {
+        _elements.reserve(capacity);
+    }
+
+    // Returns the value of this node, leaving the node empty.
+    Json freeze() {
+        switch (_kind) {
+          case VALUE:
+            break;
+          case OBJECT:
+            for (StringMap<linked_ptr<Node> >::iterator it = _open_members.begin();
+                    it != _open_members.end(); ++it) {
+                _members[it->first] = it->second->freeze();
+            }
+            _open_members.clear();
+            _value = Json::adopt_object(&_members, _allocator);
+            break;
+          case ARRAY:
+            for (map<size_t, linked_ptr<Node> >::iterator it = _open_elements.begin();
+                    it != _open_elements.end(); ++it) {
+                _elements[it->first] = it->second->freeze();
+            }
+            _open_elements.clear();
+            _value = Json::adopt_array(&_elements, _allocator);
+            break;
+        }
+        Json result = _value;
+        assign(Json());
+        return result;
+    }
+
+  private:
+    Allocator* const _allocator;
+    Kind _kind;
+    Json _value;
+    StringMap<Json> _members;
+    StringMap<linked_ptr<Node> > _open_members;
+    vector<Json> _elements;
+    map<size_t, linked_ptr<Node> > _open_elements;
+
+    DISALLOW_COPY_AND_ASSIGN(Node);
+};
+
+JsonBuilder::JsonBuilder(Allocator* allocator)
+    : _allocator(allocator),
+      _root(new Node(allocator)) { }
+
+JsonBuilder::~JsonBuilder() { }
+
+bool JsonBuilder::set(const StringSlice& path, const Json& value) {
+    if (!is_valid_json_pointer(path)) {
+        return false;
+    }
+    JsonPointerReader reader(path);
+    if (reader.done()) {
+        _root->assign(value);
+        return true;
+    }
+    Node* node = _root.get();
+    if (!node->open(Node::OBJECT)) {
+        return false;
+    }
+    StringSlice token = reader.next();
+    while (!reader.done()) {
+        node = node->child(token, Node::OBJECT);
+        if (!node) {
+            return false;
+        }
+        token = reader.next();
+    }
+    return node->set(token, value);
+}
+
+bool JsonBuilder::append(const StringSlice& path, const Json& value) {
+    Node* node = open_array(path);
+    if (!node) {
+        return false;
+    }
+    node->append(value);
+    return true;
+}
+
+bool JsonBuilder::reserve(const StringSlice& path, size_t capacity) {
+    Node* node = open_array(path);
+    if (!node) {
+        return false;
+    }
+    node->reserve(capacity);
+    return true;
+}
+
+Json JsonBuilder::freeze() {
+    return _root->freeze();
+}
+
+JsonBuilder::Node* JsonBuilder::open_array(const StringSlice& path) {
+    if (!is_valid_json_pointer(path)) {
+        return NULL;
+    }
+    JsonPointerReader reader(path);
+    Node* node = _root.get();
+    if (!node->open(reader.done() ? Node::ARRAY : Node::OBJECT)) {
+        return NULL;
+    }
+    while (!reader.done()) {
+        const StringSlice token = reader.next();
+        node = node->child(token, reader.done() ? Node::ARRAY : Node::OBJECT);
+        if (!node) {
+            return NULL;
+        }
+    }
+    return (node->kind() == Node::ARRAY) ? node : NULL;
+}
+
+}  // namespace rgos
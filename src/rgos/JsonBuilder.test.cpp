@@ -0,0 +1,114 @@
+// Copyright (c) 2009 Chris Pickel <sfiera@gmail.com>
+//
+// This file is part of librgos, a free software project.  You can redistribute it and/or modify it
+// under the terms of the MIT License.
+
+#include "rgos/JsonBuilder.hpp"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <sfz/sfz.hpp>
+#include "rgos/Serialize.hpp"
+
+using sfz::String;
+using std::vector;
+using testing::Eq;
+
+namespace rgos {
+namespace {
+
+typedef ::testing::Test JsonBuilderTest;
+
+String serialize(const Json& json) {
+    return String(json);
+}
+
+Json number(double value) {
+    return Json::number(value);
+}
+
+// Tests that paths create objects and arrays as needed, and that "-" appends.
+TEST_F(JsonBuilderTest, SetTest) {
+    JsonBuilder builder;
+    EXPECT_THAT(serialize(builder.freeze()), Eq(String("null")));
+
+    EXPECT_TRUE(builder.set("/a/b", number(1)));
+    EXPECT_TRUE(builder.set("/a/c", number(2)));
+    EXPECT_TRUE(builder.set("/a/b", number(3)));
+    EXPECT_TRUE(builder.append("/list", number(4)));
+    EXPECT_TRUE(builder.set("/list/-", number(5)));
+    EXPECT_TRUE(builder.set("/list/0", number(6)));
+    EXPECT_TRUE(builder.set("/list/-/x", number(7)));
+    EXPECT_TRUE(builder.set("/list/2/y", number(8)));
+    EXPECT_TRUE(builder.set("/n", Json()));
+    EXPECT_TRUE(builder.set("/n/m", Json::bool_(true)));
+    EXPECT_THAT(serialize(builder.freeze()), Eq(String(
+                    "{\"a\":{\"b\":3,\"c\":2},"
+                    "\"list\":[6,5,{\"x\":7,\"y\":8}],"
+                    "\"n\":{\"m\":true}}")));
+    EXPECT_THAT(serialize(builder.freeze()), Eq(String("null")));
+
+    EXPECT_TRUE(builder.set("/a~1b/c~0d", number(1)));
+    EXPECT_TRUE(builder.set("/a~1b/", number(2)));
+    EXPECT_THAT(serialize(builder.freeze()), Eq(String("{\"a/b\":{\"\":2,\"c~d\":1}}")));
+
+    EXPECT_TRUE(builder.set("", number(1)));
+    EXPECT_THAT(serialize(builder.freeze()), Eq(String("1")));
+    EXPECT_TRUE(builder.append("", number(1)));
+    EXPECT_TRUE(builder.reserve("", 10));
+    EXPECT_THAT(serialize(builder.freeze()), Eq(String("[1]")));
+}
+
+// Tests that a stored value can be edited through a path without changing the original, and
+// that its untouched subtrees are shared with the result.
+TEST_F(JsonBuilderTest, ThawTest) {
+    JsonBuilder inner;
+    inner.set("/keep/deep", number(1));
+    inner.set("/change", number(2));
+    inner.append("/items", number(3));
+    const Json original = inner.freeze();
+
+    JsonBuilder builder;
+    EXPECT_TRUE(builder.set("/doc", original));
+    EXPECT_TRUE(builder.set("/doc/change", number(4)));
+    EXPECT_TRUE(builder.append("/doc/items", number(5)));
+    Json result = builder.freeze();
+
+    EXPECT_THAT(serialize(original), Eq(String(
+                    "{\"change\":2,\"items\":[3],\"keep\":{\"deep\":1}}")));
+    EXPECT_THAT(serialize(result), Eq(String(
+                    "{\"doc\":{\"change\":4,\"items\":[3,5],\"keep\":{\"deep\":1}}}")));
+
+    JsonBuilder same;
+    same.set("/doc/change", number(4));
+    same.set("/doc/items", Json::array(vector<Json>(1, number(3))));
+    same.append("/doc/items", number(5));
+    same.set("/doc/keep/deep", number(1));
+    EXPECT_THAT(result, Eq(same.freeze()));
+}
+
+// Tests that bad paths fail and leave the document unchanged.
+TEST_F(JsonBuilderTest, FailureTest) {
+    JsonBuilder builder;
+    EXPECT_TRUE(builder.set("/s", Json::string("s")));
+    EXPECT_TRUE(builder.append("/a", number(1)));
+
+    EXPECT_FALSE(builder.set("s", number(0)));
+    EXPECT_FALSE(builder.set("/s/t", number(0)));
+    EXPECT_FALSE(builder.set("/a/x", number(0)));
+    EXPECT_FALSE(builder.set("/a/2", number(0)));
+    EXPECT_FALSE(builder.set("/a/01", number(0)));
+    EXPECT_FALSE(builder.append("/s", number(0)));
+    EXPECT_FALSE(builder.reserve("/s", 10));
+    EXPECT_FALSE(builder.append("/a/0", number(0)));
+    EXPECT_FALSE(builder.set("/s/-", number(0)));
+    EXPECT_THAT(serialize(builder.freeze()), Eq(String("{\"a\":[1],\"s\":\"s\"}")));
+
+    EXPECT_TRUE(builder.set("", number(1)));
+    EXPECT_FALSE(builder.set("/a", number(0)));
+    EXPECT_FALSE(builder.append("", number(0)));
+    EXPECT_THAT(serialize(builder.freeze()), Eq(String("1")));
+}
+
+}  // namespace
+}  // namespace rgos
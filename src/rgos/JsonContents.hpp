@@ -0,0 +1,57 @@
+// Copyright (c) 2009 Chris Pickel <sfiera@gmail.com>
+//
+// This file is part of librgos, a free software project.  You can redistribute it and/or modify it
+// under the terms of the MIT License.
+
+#ifndef RGOS_JSON_CONTENTS_HPP_
+#define RGOS_JSON_CONTENTS_HPP_
+
+#include <vector>
+#include <sfz/sfz.hpp>
+#include "rgos/Json.hpp"
+#include "rgos/JsonVisitor.hpp"
+
+namespace rgos {
+
+// Unpacks a value so that its contents can be examined directly.  `object`, `array` and `string`
+// point into the value's node, and are valid for as long as the value is.
+class JsonContents : public JsonVisitor {
+  public:
+    explicit JsonContents(const Json& json)
+        : object(NULL),
+          array(NULL),
+          is_string(false),
+          is_number(false),
+          number(0),
+          is_null(false) {
+        json.accept(this);
+    }
+
+    virtual void visit_object(const StringMap<Json>& value) { object = &value; }
+    virtual void visit_array(const std::vector<Json>& value) { array = &value; }
+    virtual void visit_string(const sfz::StringSlice& value) {
+        is_string = true;
+        string = value;
+    }
+    virtual void visit_number(double value) {
+        is_number = true;
+        number = value;
+    }
+    virtual void visit_bool(bool value) { }
+    virtual void visit_null() { is_null = true; }
+
+    const StringMap<Json>* object;
+    const std::vector<Json>* array;
+    bool is_string;
+    sfz::StringSlice string;
+    bool is_number;
+    double number;
+    bool is_null;
+
+  private:
+    DISALLOW_COPY_AND_ASSIGN(JsonContents);
+};
+
+}  // namespace rgos
+
+#endif  // RGOS_JSON_CONTENTS_HPP_
@@ -0,0 +1,94 @@
+// Copyright (c) 2009 Chris Pickel <sfiera@gmail.com>
+//
+// This file is part of librgos, a free software project.  You can redistribute it and/or modify it
+// under the terms of the MIT License.
+
+#include "JsonPointer.hpp"
+
+using sfz::Rune;
+using sfz::String;
+using sfz::StringSlice;
+using sfz::linked_ptr;
+
+namespace rgos {
+
+bool parse_json_pointer(const StringSlice& string, JsonPointer* pointer) {
+    if (!is_valid_json_pointer(string)) {
+        return false;
+    }
+    JsonPointerReader reader(string);
+    while (!reader.done()) {
+        pointer->push_back(linked_ptr<String>(new String(reader.next())));
+    }
+    return true;
+}
+
+bool is_valid_json_pointer(const StringSlice& string) {
+    if (string.empty()) {
+        return true;
+    } else if (string.at(0) != '/') {
+        return false;
+    }
+    for (size_t i = 0; i < string.size(); ++i) {
+        if (string.at(i) == '~') {
+            if ((++i == string.size()) || ((string.at(i) != '0') && (string.at(i) != '1'))) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+StringSlice JsonPointerReader::next() {
+    const size_t start = _position + 1;
+    bool escaped = false;
+    for (_position = start; _position < _pointer.size(); ++_position) {
+        const Rune r = _pointer.at(_position);
+        if (r == '/') {
+            break;
+        } else if (r == '~') {
+            escaped = true;
+        }
+    }
+    const StringSlice token = _pointer.slice(start, _position - start);
+    if (!escaped) {
+        return token;
+    }
+    _unescaped.clear();
+    for (size_t i = 0; i < token.size(); ++i) {
+        const Rune r = token.at(i);
+        if (r == '~') {
+            _unescaped.push(1, (token.at(++i) == '0') ? '~' : '/');
+        } else {
+            _unescaped.push(1, r);
+        }
+    }
+    return _unescaped;
+}
+
+bool parse_array_index(const StringSlice& token, size_t size, bool allow_end, size_t* index) {
+    if (allow_end && (token == StringSlice("-"))) {
+        *index = size;
+        return true;
+    } else if (token.empty() || ((token.size() > 1) && (token.at(0) == '0'))) {
+        return false;
+    }
+    size_t value = 0;
+    for (size_t i = 0; i < token.size(); ++i) {
+        const Rune r = token.at(i);
+        if ((r < '0') || (r > '9')) {
+            return false;
+        }
+        value = (value * 10) + (r - '0');
+        if (value > size) {
+            return false;  // Also keeps `value` from overflowing.
+        }
+    }
+    if ((value == size) && !allow_end) {
+        return false;
+    }
+    *index = value;
+    return true;
+}
+
+}  // namespace rgos
@@ -0,0 +1,51 @@
+// Copyright (c) 2009 Chris Pickel <sfiera@gmail.com>
+//
+// This file is part of librgos, a free software project.  You can redistribute it and/or modify it
+// under the terms of the MIT License.
+
+#ifndef RGOS_JSON_POINTER_HPP_
+#define RGOS_JSON_POINTER_HPP_
+
+#include <vector>
+#include <sfz/sfz.hpp>
+
+namespace rgos {
+
+// The unescaped tokens of a JSON Pointer (RFC 6901).  The empty pointer, which refers to the
+// whole document, has no tokens.
+typedef std::vector<sfz::linked_ptr<sfz::String> > JsonPointer;
+
+// Appends the tokens of `string` to `pointer`.  Returns false if `string` is not a valid pointer.
+bool parse_json_pointer(const sfz::StringSlice& string, JsonPointer* pointer);
+
+bool is_valid_json_pointer(const sfz::StringSlice& string);
+
+// Reads the tokens of a valid JSON Pointer one at a time.  A token without escapes is returned as
+// a slice of the pointer itself, so reading it does not allocate.
+class JsonPointerReader {
+  public:
+    explicit JsonPointerReader(const sfz::StringSlice& pointer)
+        : _pointer(pointer),
+          _position(0) { }
+
+    bool done() const { return _position == _pointer.size(); }
+
+    // Returns the next token, which is valid until the following call.  Must not be called once
+    // done() is true.
+    sfz::StringSlice next();
+
+  private:
+    const sfz::StringSlice _pointer;
+    size_t _position;
+    sfz::String _unescaped;
+
+    DISALLOW_COPY_AND_ASSIGN(JsonPointerReader);
+};
+
+// Parses `token` as an index into an array of `size` elements.  If `allow_end`, then `size`
+// itself (written as "-" or as a number) is also accepted, as the position to add at.
+bool parse_array_index(const sfz::StringSlice& token, size_t size, bool allow_end, size_t* index);
+
+}  // namespace rgos
+
+#endif  // RGOS_JSON_POINTER_HPP_
@@ -0,0 +1,138 @@
+// Copyright (c) 2009 Chris Pickel <sfiera@gmail.com>
+//
+// This file is part of librgos, a free software project.  You can redistribute it and/or modify it
+// under the terms of the MIT License.
+
+#include "rgos/JsonWalker.hpp"
+
+#include "rgos/JsonVisitor.hpp"
+
+using sfz::StringSlice;
+using std::vector;
+
+namespace rgos {
+
+namespace {
+
+// Reports scalars straight to the event visitor, and records containers so that the walker can
+// push a frame for them instead of recursing.
+class Unpacker : public JsonVisitor {
+  public:
+    explicit Unpacker(JsonEventVisitor* visitor)
+        : object(NULL),
+          array(NULL),
+          action(JsonEventVisitor::CONTINUE),
+          _visitor(visitor) { }
+
+    virtual void visit_object(const StringMap<Json>& value) { object = &value; }
+    virtual void visit_array(const vector<Json>& value) { array = &value; }
+    virtual void visit_string(const StringSlice& value) { action = _visitor->visit_string(value); }
+    virtual void visit_number(double value) { action = _visitor->visit_number(value); }
+    virtual void visit_bool(bool value) { action = _visitor->visit_bool(value); }
+    virtual void visit_null() { action = _visitor->visit_null(); }
+
+    const StringMap<Json>* object;
+    const vector<Json>* array;
+    JsonEventVisitor::Action action;  // Returned by the scalar's event, if any.
+
+  private:
+    JsonEventVisitor* const _visitor;
+
+    DISALLOW_COPY_AND_ASSIGN(Unpacker);
+};
+
+}  // namespace
+
+JsonEventVisitor::~JsonEventVisitor() { }
+
+JsonEventVisitor::Action JsonEventVisitor::enter_value(const Json& value) {
+    return CONTINUE;
+}
+
+JsonWalker::JsonWalker(const Json& json)
+    : _root(json),
+      _started(false),
+      _stopped(false) { }
+
+void JsonWalker::reset(const Json& json) {
+    _root = json;
+    _started = false;
+    _stopped = false;
+    _stack.clear();
+}
+
+bool JsonWalker::step(JsonEventVisitor* visitor) {
+    if (!_started) {
+        _started = true;
+        enter(_root, visitor);
+        return true;
+    } else if (done()) {
+        return false;
+    }
+
+    Frame& top = _stack.back();
+    if (top.object) {
+        if (top.member == top.object->end()) {
+            const StringMap<Json>& object = *top.object;
+            _stack.pop_back();
+            proceed(visitor->end_object(object));
+        } else {
+            const StringMap<Json>::value_type& member = *top.member;
+            ++top.member;
+            if (proceed(visitor->object_key(member.first, top.index++))) {
+                enter(member.second, visitor);  // May invalidate `top`.
+            }
+        }
+    } else {
+        if (top.index == top.array->size()) {
+            const vector<Json>& array = *top.array;
+            _stack.pop_back();
+            proceed(visitor->end_array(array));
+        } else {
+            const Json& element = (*top.array)[top.index];
+            if (proceed(visitor->array_element(top.index++))) {
+                enter(element, visitor);  // May invalidate `top`.
+            }
+        }
+    }
+    return true;
+}
+
+void JsonWalker::enter(const Json& value, JsonEventVisitor* visitor) {
+    if (!proceed(visitor->enter_value(value))) {
+        return;
+    }
+    Unpacker unpacker(visitor);
+    value.accept(&unpacker);
+    if (unpacker.object) {
+        Frame frame = { unpacker.object, unpacker.object->begin(), NULL, 0 };
+        _stack.push_back(frame);
+        if (!proceed(visitor->begin_object(*unpacker.object)) && !_stopped) {
+            _stack.back().member = unpacker.object->end();
+        }
+    } else if (unpacker.array) {
+        Frame frame = { NULL, StringMap<Json>::const_iterator(), unpacker.array, 0 };
+        _stack.push_back(frame);
+        if (!proceed(visitor->begin_array(*unpacker.array)) && !_stopped) {
+            _stack.back().index = unpacker.array->size();
+        }
+    } else {
+        proceed(unpacker.action);
+    }
+}
+
+bool JsonWalker::proceed(JsonEventVisitor::Action action) {
+    if (action == JsonEventVisitor::STOP) {
+        _stopped = true;
+        _stack.clear();
+    }
+    return action == JsonEventVisitor::CONTINUE;
+}
+
+bool walk(const Json& json, JsonEventVisitor* visitor) {
+    JsonWalker walker(json);
+    while (walker.step(visitor)) { }
+    return !walker.stopped();
+}
+
+}  // namespace rgos
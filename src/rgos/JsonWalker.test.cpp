@@ -0,0 +1,211 @@
+// Copyright (c) 2009 Chris Pickel <sfiera@gmail.com>
+//
+// This file is part of librgos, a free software project.  You can redistribute it and/or modify it
+// under the terms of the MIT License.
+
+#include "rgos/JsonWalker.hpp"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <sfz/sfz.hpp>
+#include "rgos/Json.hpp"
+#include "rgos/Serialize.hpp"
+
+using sfz::StringSlice;
+using std::make_pair;
+using std::vector;
+using testing::Eq;
+using testing::InSequence;
+using testing::Return;
+using testing::StrictMock;
+using testing::_;
+
+namespace rgos {
+namespace {
+
+class MockJsonEventVisitor : public JsonEventVisitor {
+  public:
+    MOCK_METHOD1(enter_value, Action(const Json& value));
+    MOCK_METHOD1(begin_object, Action(const StringMap<Json>& value));
+    MOCK_METHOD2(object_key, Action(const StringSlice& key, size_t index));
+    MOCK_METHOD1(end_object, Action(const StringMap<Json>& value));
+    MOCK_METHOD1(begin_array, Action(const vector<Json>& value));
+    MOCK_METHOD1(array_element, Action(size_t index));
+    MOCK_METHOD1(end_array, Action(const vector<Json>& value));
+    MOCK_METHOD1(visit_string, Action(const StringSlice& value));
+    MOCK_METHOD1(visit_number, Action(double value));
+    MOCK_METHOD1(visit_bool, Action(bool value));
+    MOCK_METHOD0(visit_null, Action());
+};
+
+// Counts events, without keeping any other state.
+class CountingVisitor : public JsonEventVisitor {
+  public:
+    CountingVisitor() : containers(0), scalars(0) { }
+    virtual Action begin_object(const StringMap<Json>& value) { ++containers; return CONTINUE; }
+    virtual Action object_key(const StringSlice& key, size_t index) { return CONTINUE; }
+    virtual Action end_object(const StringMap<Json>& value) { return CONTINUE; }
+    virtual Action begin_array(const vector<Json>& value) { ++containers; return CONTINUE; }
+    virtual Action array_element(size_t index) { return CONTINUE; }
+    virtual Action end_array(const vector<Json>& value) { return CONTINUE; }
+    virtual Action visit_string(const StringSlice& value) { ++scalars; return CONTINUE; }
+    virtual Action visit_number(double value) { ++scalars; return CONTINUE; }
+    virtual Action visit_bool(bool value) { ++scalars; return CONTINUE; }
+    virtual Action visit_null() { ++scalars; return CONTINUE; }
+    size_t containers;
+    size_t scalars;
+};
+
+typedef ::testing::Test JsonWalkerTest;
+
+TEST_F(JsonWalkerTest, ScalarTest) {
+    StrictMock<MockJsonEventVisitor> visitor;
+    {
+        InSequence s;
+        EXPECT_CALL(visitor, enter_value(_)).WillOnce(Return(JsonEventVisitor::CONTINUE));
+        EXPECT_CALL(visitor, visit_number(1.0));
+    }
+    JsonWalker walker(Json::number(1.0));
+    EXPECT_FALSE(walker.done());
+    EXPECT_TRUE(walker.step(&visitor));
+    EXPECT_TRUE(walker.done());
+    EXPECT_FALSE(walker.step(&visitor));
+}
+
+// {"a": [true, null], "b": {}}
+TEST_F(JsonWalkerTest, ContainerTest) {
+    vector<Json> a;
+    a.push_back(Json::bool_(true));
+    a.push_back(Json());
+    StringMap<Json> o;
+    o.insert(make_pair("a", Json::array(a)));
+    o.insert(make_pair("b", Json::object(StringMap<Json>())));
+    Json json = Json::object(o);
+
+    StrictMock<MockJsonEventVisitor> visitor;
+    EXPECT_CALL(visitor, enter_value(_)).WillRepeatedly(Return(JsonEventVisitor::CONTINUE));
+    {
+        InSequence s;
+        EXPECT_CALL(visitor, begin_object(_));
+        EXPECT_CALL(visitor, object_key(Eq<StringSlice>("a"), 0));
+        EXPECT_CALL(visitor, begin_array(_));
+        EXPECT_CALL(visitor, array_element(0));
+        EXPECT_CALL(visitor, visit_bool(true));
+        EXPECT_CALL(visitor, array_element(1));
+        EXPECT_CALL(visitor, visit_null());
+        EXPECT_CALL(visitor, end_array(_));
+        EXPECT_CALL(visitor, object_key(Eq<StringSlice>("b"), 1));
+        EXPECT_CALL(visitor, begin_object(_));
+        EXPECT_CALL(visitor, end_object(_));
+        EXPECT_CALL(visitor, end_object(_));
+    }
+    walk(json, &visitor);
+}
+
+TEST_F(JsonWalkerTest, SkipTest) {
+    vector<Json> inner;
+    inner.push_back(Json::number(1.0));
+    vector<Json> outer;
+    outer.push_back(Json::array(inner));
+    outer.push_back(Json::number(2.0));
+
+    StrictMock<MockJsonEventVisitor> visitor;
+    {
+        InSequence s;
+        EXPECT_CALL(visitor, enter_value(_)).WillOnce(Return(JsonEventVisitor::CONTINUE));
+        EXPECT_CALL(visitor, begin_array(_));
+        EXPECT_CALL(visitor, array_element(0));
+        EXPECT_CALL(visitor, enter_value(Eq(Json::array(inner))))
+            .WillOnce(Return(JsonEventVisitor::SKIP));
+        EXPECT_CALL(visitor, array_element(1));
+        EXPECT_CALL(visitor, enter_value(_)).WillOnce(Return(JsonEventVisitor::CONTINUE));
+        EXPECT_CALL(visitor, visit_number(2.0));
+        EXPECT_CALL(visitor, end_array(_));
+    }
+    walk(Json::array(outer), &visitor);
+}
+
+// [[1, 2], {"a": 3, "b": 4}, [5]]
+Json skip_stop_document() {
+    vector<Json> first;
+    first.push_back(Json::number(1.0));
+    first.push_back(Json::number(2.0));
+    StringMap<Json> second;
+    second.insert(make_pair("a", Json::number(3.0)));
+    second.insert(make_pair("b", Json::number(4.0)));
+    vector<Json> outer;
+    outer.push_back(Json::array(first));
+    outer.push_back(Json::object(second));
+    outer.push_back(Json::array(vector<Json>(1, Json::number(5.0))));
+    return Json::array(outer);
+}
+
+TEST_F(JsonWalkerTest, SkipMembersTest) {
+    StrictMock<MockJsonEventVisitor> visitor;
+    EXPECT_CALL(visitor, enter_value(_)).WillRepeatedly(Return(JsonEventVisitor::CONTINUE));
+    {
+        InSequence s;
+        EXPECT_CALL(visitor, begin_array(_));
+        EXPECT_CALL(visitor, array_element(0));
+        EXPECT_CALL(visitor, begin_array(_)).WillOnce(Return(JsonEventVisitor::SKIP));
+        EXPECT_CALL(visitor, end_array(_));  // Still reported, but without the members.
+        EXPECT_CALL(visitor, array_element(1));
+        EXPECT_CALL(visitor, begin_object(_));
+        EXPECT_CALL(visitor, object_key(Eq<StringSlice>("a"), 0))
+            .WillOnce(Return(JsonEventVisitor::SKIP));
+        EXPECT_CALL(visitor, object_key(Eq<StringSlice>("b"), 1));
+        EXPECT_CALL(visitor, visit_number(4.0));
+        EXPECT_CALL(visitor, end_object(_));
+        EXPECT_CALL(visitor, array_element(2));
+        EXPECT_CALL(visitor, begin_array(_));
+        EXPECT_CALL(visitor, array_element(0));
+        EXPECT_CALL(visitor, visit_number(5.0));
+        EXPECT_CALL(visitor, end_array(_));
+        EXPECT_CALL(visitor, end_array(_));
+    }
+    EXPECT_TRUE(walk(skip_stop_document(), &visitor));
+}
+
+TEST_F(JsonWalkerTest, StopTest) {
+    StrictMock<MockJsonEventVisitor> visitor;
+    EXPECT_CALL(visitor, enter_value(_)).WillRepeatedly(Return(JsonEventVisitor::CONTINUE));
+    {
+        InSequence s;
+        EXPECT_CALL(visitor, begin_array(_));
+        EXPECT_CALL(visitor, array_element(0));
+        EXPECT_CALL(visitor, begin_array(_));
+        EXPECT_CALL(visitor, array_element(0));
+        EXPECT_CALL(visitor, visit_number(1.0));
+        EXPECT_CALL(visitor, array_element(1));
+        EXPECT_CALL(visitor, visit_number(2.0)).WillOnce(Return(JsonEventVisitor::STOP));
+    }
+    JsonWalker walker(skip_stop_document());
+    while (walker.step(&visitor)) { }
+    EXPECT_TRUE(walker.done());
+    EXPECT_TRUE(walker.stopped());
+    EXPECT_FALSE(walker.step(&visitor));
+
+    StrictMock<MockJsonEventVisitor> root_visitor;
+    EXPECT_CALL(root_visitor, enter_value(_)).WillOnce(Return(JsonEventVisitor::STOP));
+    EXPECT_FALSE(walk(skip_stop_document(), &root_visitor));
+}
+
+TEST_F(JsonWalkerTest, DeepTest) {
+    const size_t kDepth = 100000;
+    Json json = Json::number(1.0);
+    for (size_t i = 0; i < kDepth; ++i) {
+        vector<Json> level;
+        level.push_back(json);
+        json = Json::array(level);
+    }
+
+    CountingVisitor visitor;
+    walk(json, &visitor);
+    EXPECT_THAT(visitor.containers, Eq(kDepth));
+    EXPECT_THAT(visitor.scalars, Eq(1u));
+
+    EXPECT_THAT(serialized_size(json), Eq(2 * kDepth + sfz::String(Json::number(1.0)).size()));
+}
+
+}  // namespace
+}  // namespace rgos
@@ -0,0 +1,58 @@
+// Copyright (c) 2009 Chris Pickel <sfiera@gmail.com>
+//
+// This file is part of librgos, a free software project.  You can redistribute it and/or modify it
+// under the terms of the MIT License.
+
+#include "rgos/Patch.hpp"
+
+#include <vector>
+#include <sfz/sfz.hpp>
+#include "Bench.hpp"
+
+using std::make_pair;
+using std::vector;
+
+namespace rgos {
+namespace {
+
+Json one_change_patch() {
+    StringMap<Json> operation;
+    operation.insert(make_pair(sfz::StringSlice("op"), Json::string("replace")));
+    operation.insert(make_pair(sfz::StringSlice("path"), Json::string("/key005000")));
+    operation.insert(make_pair(sfz::StringSlice("value"), Json::number(1.0)));
+    return Json::array(vector<Json>(1, Json::object(operation)));
+}
+
+// Applying one change to a 10000-member object copies the member map, but no member values.
+BENCHMARK(ApplyPatchWide10k) {
+    const Json from = wide_corpus(10000);
+    const Json patch = one_change_patch();
+    state->start();
+    for (size_t i = 0; i < state->iterations; ++i) {
+        Json to;
+        apply_patch(from, patch, &to);
+    }
+}
+
+// The unchanged members share their nodes, so only one member is descended into.
+BENCHMARK(DiffWide10kOneChange) {
+    const Json from = wide_corpus(10000);
+    Json to;
+    apply_patch(from, one_change_patch(), &to);
+    state->start();
+    for (size_t i = 0; i < state->iterations; ++i) {
+        diff(from, to);
+    }
+}
+
+BENCHMARK(DiffDeep10kLeafChange) {
+    const Json from = deep_corpus(10000);
+    const Json to = deep_corpus(10001);
+    state->start();
+    for (size_t i = 0; i < state->iterations; ++i) {
+        diff(from, to);
+    }
+}
+
+}  // namespace
+}  // namespace rgos
@@ -0,0 +1,340 @@
+// Copyright (c) 2009 Chris Pickel <sfiera@gmail.com>
+//
+// This file is part of librgos, a free software project.  You can redistribute it and/or modify it
+// under the terms of the MIT License.
+
+#include "rgos/Patch.hpp"
+
+#include <stdio.h>
+#include <algorithm>
+#include <vector>
+#include <sfz/sfz.hpp>
+#include "JsonContents.hpp"
+#include "JsonPointer.hpp"
+
+using sfz::Rune;
+using sfz::String;
+using sfz::StringSlice;
+using sfz::linked_ptr;
+using std::make_pair;
+using std::min;
+using std::vector;
+
+namespace rgos {
+
+namespace {
+
+// One step of a path being built by Differ: an object member or an array index.
+struct PathToken {
+    explicit PathToken(const StringSlice& key) : key(key), index(0), is_index(false) { }
+    explicit PathToken(size_t index) : index(index), is_index(true) { }
+
+    StringSlice key;
+    size_t index;
+    bool is_index;
+};
+
+class Differ {
+  public:
+    explicit Differ(vector<Json>* operations) : _operations(operations) { }
+
+    void diff(const Json& from, const Json& to) {
+        if (from == to) {
+            return;
+        }
+        JsonContents from_contents(from);
+        JsonContents to_contents(to);
+        if (from_contents.object && to_contents.object) {
+            diff_objects(*from_contents.object, *to_contents.object);
+        } else if (from_contents.array && to_contents.array) {
+            diff_arrays(*from_contents.array, *to_contents.array);
+        } else {
+            emit("replace", &to);
+        }
+    }
+
+  private:
+    // Members are matched up by lookup, so that the result does not depend on the order in which
+    // the maps iterate.  Removals and changes come first, in the order of `from`, then additions.
+    void diff_objects(const StringMap<Json>& from, const StringMap<Json>& to) {
+        for (StringMap<Json>::const_iterator f = from.begin(); f != from.end(); ++f) {
+            _path.push_back(PathToken(f->first));
+            StringMap<Json>::const_iterator t = to.find(f->first);
+            if (t == to.end()) {
+                emit("remove", NULL);
+            } else {
+                diff(f->second, t->second);
+            }
+            _path.pop_back();
+        }
+        for (StringMap<Json>::const_iterator t = to.begin(); t != to.end(); ++t) {
+            if (from.find(t->first) == from.end()) {
+                _path.push_back(PathToken(t->first));
+                emit("add", &t->second);
+                _path.pop_back();
+            }
+        }
+    }
+
+    void diff_arrays(const vector<Json>& from, const vector<Json>& to) {
+        size_t prefix = 0;
+        while ((prefix < from.size()) && (prefix < to.size()) && (from[prefix] == to[prefix])) {
+            ++prefix;
+        }
+        size_t suffix = 0;
+        while ((prefix + suffix < from.size()) && (prefix + suffix < to.size())
+                && (from[from.size() - 1 - suffix] == to[to.size() - 1 - suffix])) {
+            ++suffix;
+        }
+        const size_t from_size = from.size() - prefix - suffix;
+        const size_t to_size = to.size() - prefix - suffix;
+        const size_t common = min(from_size, to_size);
+
+        for (size_t i = 0; i < common; ++i) {
+            _path.push_back(PathToken(prefix + i));
+            diff(from[prefix + i], to[prefix + i]);
+            _path.pop_back();
+        }
+        // Each removal shifts the next element into the same index.
+        for (size_t i = common; i < from_size; ++i) {
+            _path.push_back(PathToken(prefix + common));
+            emit("remove", NULL);
+            _path.pop_back();
+        }
+        for (size_t i = common; i < to_size; ++i) {
+            _path.push_back(PathToken(prefix + i));
+            emit("add", &to[prefix + i]);
+            _path.pop_back();
+        }
+    }
+
+    void emit(const char* op, const Json* value) {
+        String path;
+        foreach (const PathToken& token, _path) {
+            path.push(1, '/');
+            if (token.is_index) {
+                char digits[32];
+                snprintf(digits, sizeof(digits), "%zu", token.index);
+                path.push(digits);
+            } else {
+                for (size_t i = 0; i < token.key.size(); ++i) {
+                    const Rune r = token.key.at(i);
+                    if (r == '~') {
+                        path.push("~0");
+                    } else if (r == '/') {
+                        path.push("~1");
+                    } else {
+                        path.push(1, r);
+                    }
+                }
+            }
+        }
+
+        StringMap<Json> operation;
+        operation.insert(make_pair(StringSlice("op"), Json::string(op)));
+        operation.insert(make_pair(StringSlice("path"), Json::string(path)));
+        if (value) {
+            operation.insert(make_pair(StringSlice("value"), *value));
+        }
+        _operations->push_back(Json::object(operation));
+    }
+
+    vector<PathToken> _path;
+    vector<Json>* const _operations;
+
+    DISALLOW_COPY_AND_ASSIGN(Differ);
+};
+
+// Stores the value at `pointer` in `result`, if there is one.
+bool get(const Json& json, const JsonPointer& pointer, Json* result) {
+    Json node = json;
+    foreach (const linked_ptr<String>& token, pointer) {
+        JsonContents contents(node);
+        Json child;
+        if (contents.object) {
+            StringMap<Json>::const_iterator it = contents.object->find(*token);
+            if (it == contents.object->end()) {
+                return false;
+            }
+            child = it->second;
+        } else if (contents.array) {
+            size_t index;
+            if (!parse_array_index(*token, contents.array->size(), false, &index)) {
+                return false;
+            }
+            child = (*contents.array)[index];
+        } else {
+            return false;
+        }
+        node = child;
+    }
+    *result = node;
+    return true;
+}
+
+enum Edit {
+    ADD,
+    REMOVE,
+    REPLACE
+};
+
+// Stores in `result` a copy of `json` with `edit` applied at the tokens of `pointer` from `depth`
+// on.  Only the containers along that path are copied; each copy is shallow.
+bool edit(const Json& json, const JsonPointer& pointer, size_t depth, Edit edit_type,
+          const Json& value, Json* result) {
+    if (depth == pointer.size()) {
+        // Only reached for the empty pointer, which refers to the whole document.
+        if (edit_type == REMOVE) {
+            return false;
+        }
+        *result = value;
+        return true;
+    }
+
+    const StringSlice token = *pointer[depth];
+    const bool last = (depth + 1 == pointer.size());
+    JsonContents contents(json);
+    if (contents.object) {
+        StringMap<Json> members(*contents.object);
+        StringMap<Json>::iterator it = members.find(token);
+        if (last && (edit_type == ADD)) {
+            members[token] = value;
+        } else if (it == members.end()) {
+            return false;
+        } else if (!last) {
+            Json child;
+            if (!edit(it->second, pointer, depth + 1, edit_type, value, &child)) {
+                return false;
+            }
+            it->second = child;
+        } else if (edit_type == REMOVE) {
+            members.erase(token);
+        } else {
+            it->second = value;
+        }
+        *result = Json::object(members);
+        return true;
+    } else if (contents.array) {
+        vector<Json> elements(*contents.array);
+        size_t index;
+        if (!parse_array_index(token, elements.size(), last && (edit_type == ADD), &index)) {
+            return false;
+        } else if (!last) {
+            Json child;
+            if (!edit(elements[index], pointer, depth + 1, edit_type, value, &child)) {
+                return false;
+            }
+            elements[index] = child;
+        } else if (edit_type == ADD) {
+            elements.insert(elements.begin() + index, value);
+        } else if (edit_type == REMOVE) {
+            elements.erase(elements.begin() + index);
+        } else {
+            elements[index] = value;
+        }
+        *result = Json::array(elements);
+        return true;
+    }
+    return false;
+}
+
+bool string_member(const StringMap<Json>& object, const char* name, String* value) {
+    StringMap<Json>::const_iterator it = object.find(name);
+    if (it == object.end()) {
+        return false;
+    }
+    JsonContents contents(it->second);
+    if (!contents.is_string) {
+        return false;
+    }
+    value->push(contents.string);
+    return true;
+}
+
+bool pointer_member(const StringMap<Json>& object, const char* name, JsonPointer* pointer) {
+    String string;
+    return string_member(object, name, &string) && parse_json_pointer(string, pointer);
+}
+
+bool apply_operation(const Json& json, const Json& operation, Json* result) {
+    JsonContents contents(operation);
+    String op_storage;
+    JsonPointer path;
+    if (!contents.object
+            || !string_member(*contents.object, "op", &op_storage)
+            || !pointer_member(*contents.object, "path", &path)) {
+        return false;
+    }
+    const StringMap<Json>& members = *contents.object;
+    const StringSlice op(op_storage);
+
+    if ((op == StringSlice("move")) || (op == StringSlice("copy"))) {
+        JsonPointer from;
+        Json value;
+        if (!pointer_member(members, "from", &from) || !get(json, from, &value)) {
+            return false;
+        } else if (op == StringSlice("copy")) {
+            return edit(json, path, 0, ADD, value, result);
+        }
+        // A value can't be moved into one of its own children.
+        if (from.size() < path.size()) {
+            bool prefix = true;
+            for (size_t i = 0; prefix && (i < from.size()); ++i) {
+                prefix = (StringSlice(*from[i]) == StringSlice(*path[i]));
+            }
+            if (prefix) {
+                return false;
+            }
+        }
+        Json removed;
+        return edit(json, from, 0, REMOVE, Json(), &removed)
+            && edit(removed, path, 0, ADD, value, result);
+    } else if (op == StringSlice("remove")) {
+        return edit(json, path, 0, REMOVE, Json(), result);
+    }
+
+    StringMap<Json>::const_iterator value = members.find("value");
+    if (value == members.end()) {
+        return false;
+    } else if (op == StringSlice("add")) {
+        return edit(json, path, 0, ADD, value->second, result);
+    } else if (op == StringSlice("replace")) {
+        return edit(json, path, 0, REPLACE, value->second, result);
+    } else if (op == StringSlice("test")) {
+        Json actual;
+        if (!get(json, path, &actual) || (actual != value->second)) {
+            return false;
+        }
+        *result = json;
+        return true;
+    }
+    return false;
+}
+
+}  // namespace
+
+Json diff(const Json& from, const Json& to) {
+    vector<Json> operations;
+    Differ differ(&operations);
+    differ.diff(from, to);
+    return Json::array(operations);
+}
+
+bool apply_patch(const Json& json, const Json& patch, Json* result) {
+    JsonContents operations(patch);
+    if (!operations.array) {
+        return false;
+    }
+    Json current = json;
+    foreach (const Json& operation, *operations.array) {
+        Json updated;
+        if (!apply_operation(current, operation, &updated)) {
+            return false;
+        }
+        current = updated;
+    }
+    *result = current;
+    return true;
+}
+
+}  // namespace rgos
@@ -0,0 +1,232 @@
+// Copyright (c) 2009 Chris Pickel <sfiera@gmail.com>
+//
+// This file is part of librgos, a free software project.  You can redistribute it and/or modify it
+// under the terms of the MIT License.
+
+#include "rgos/Patch.hpp"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <sfz/sfz.hpp>
+#include "rgos/JsonVisitor.hpp"
+#include "rgos/Serialize.hpp"
+
+using sfz::String;
+using sfz::StringSlice;
+using std::vector;
+using testing::Eq;
+using testing::NotNull;
+
+namespace rgos {
+namespace {
+
+typedef ::testing::Test PatchTest;
+
+// Accumulates members for Json::object().
+class Members {
+  public:
+    Members& set(const char* key, const Json& value) {
+        _members[key] = value;
+        return *this;
+    }
+    Json build() const { return Json::object(_members); }
+
+  private:
+    StringMap<Json> _members;
+};
+
+// Builds an array of up to five elements; trailing nulls are dropped.
+Json array(const Json& a, const Json& b = Json(), const Json& c = Json(), const Json& d = Json(),
+           const Json& e = Json()) {
+    const Json all[] = {a, b, c, d, e};
+    vector<Json> elements;
+    for (int i = 0; (i < 5) && (all[i] != Json()); ++i) {
+        elements.push_back(all[i]);
+    }
+    return Json::array(elements);
+}
+
+Json member(const Json& object, const char* key) {
+    struct Finder : public JsonDefaultVisitor {
+        virtual void visit_object(const StringMap<Json>& value) {
+            result = value.find(key)->second;
+        }
+        virtual void visit_default(const char* type) { }
+        const char* key;
+        Json result;
+    } finder;
+    finder.key = key;
+    object.accept(&finder);
+    return finder.result;
+}
+
+String serialize(const Json& json) {
+    return String(json);
+}
+
+Json number(double value) {
+    return Json::number(value);
+}
+
+Json string(const char* value) {
+    return Json::string(value);
+}
+
+TEST_F(PatchTest, DiffTest) {
+    Json from = Members()
+        .set("name", string("a"))
+        .set("old", Json::bool_(false))
+        .set("port", number(80))
+        .set("tags", array(string("x"), string("y")))
+        .build();
+    Json to = Members()
+        .set("name", string("a"))
+        .set("new", Json::bool_(true))
+        .set("port", number(8080))
+        .set("tags", array(string("x"), string("z"), string("y")))
+        .build();
+    EXPECT_THAT(serialize(diff(from, to)), Eq(String(
+                "[{\"op\":\"remove\",\"path\":\"/old\"},"
+                "{\"op\":\"replace\",\"path\":\"/port\",\"value\":8080},"
+                "{\"op\":\"add\",\"path\":\"/tags/1\",\"value\":\"z\"},"
+                "{\"op\":\"add\",\"path\":\"/new\",\"value\":true}]")));
+
+    EXPECT_THAT(serialize(diff(from, from)), Eq(String("[]")));
+    EXPECT_THAT(serialize(diff(from, Members().set("name", string("a")).build())), Eq(String(
+                "[{\"op\":\"remove\",\"path\":\"/old\"},"
+                "{\"op\":\"remove\",\"path\":\"/port\"},"
+                "{\"op\":\"remove\",\"path\":\"/tags\"}]")));
+    EXPECT_THAT(serialize(diff(number(1), string("a"))), Eq(String(
+                "[{\"op\":\"replace\",\"path\":\"\",\"value\":\"a\"}]")));
+
+    // "~" and "/" in keys are escaped.
+    EXPECT_THAT(serialize(diff(
+                    Members().set("a/b", number(1)).set("c~d", number(1)).build(),
+                    Members().set("a/b", number(2)).set("c~d", number(2)).build())),
+                Eq(String(
+                "[{\"op\":\"replace\",\"path\":\"/a~1b\",\"value\":2},"
+                "{\"op\":\"replace\",\"path\":\"/c~0d\",\"value\":2}]")));
+}
+
+// Tests that `diff(from, to)` applied to `from` gives `to`.
+void round_trip(const Json& from, const Json& to) {
+    Json patched;
+    ASSERT_THAT(apply_patch(from, diff(from, to), &patched), Eq(true));
+    EXPECT_THAT(serialize(patched), Eq(serialize(to)));
+    EXPECT_THAT(serialize(diff(to, patched)), Eq(String("[]")));
+}
+
+TEST_F(PatchTest, RoundTripTest) {
+    const Json pairs[][2] = {
+        {array(number(1), number(2), number(3), number(4), number(5)),
+         array(number(1), number(9), number(5))},
+        {array(number(1), number(2)), array(number(0), number(1), number(2), number(3))},
+        {array(number(1)), Members().set("a", number(1)).build()},
+        {Members().set("a", array(Members().set("b", number(1)).build())).build(),
+         Members().set("a", array(Members().set("b", number(2)).build(), number(0))).build()},
+        {Members().set("a/b", number(1)).set("~", number(2)).build(),
+         Members().set("~", number(3)).set("", number(4)).build()},
+    };
+    for (size_t i = 0; i < sizeof(pairs) / sizeof(pairs[0]); ++i) {
+        round_trip(pairs[i][0], pairs[i][1]);
+    }
+
+    // Keys that differ after a character above U+00FF.
+    String a_macron;
+    a_macron.push(1, 0x101);
+    a_macron.push(1, 'a');
+    String capital_a_macron;
+    capital_a_macron.push(1, 0x100);
+    capital_a_macron.push(1, 'b');
+    StringMap<Json> from;
+    from[a_macron] = number(1);
+    from[capital_a_macron] = number(2);
+    StringMap<Json> to;
+    to[capital_a_macron] = number(2);
+    round_trip(Json::object(from), Json::object(to));
+    round_trip(Json::object(to), Json::object(from));
+}
+
+TEST_F(PatchTest, SharingTest) {
+    Json big = array(string("a large"), string("subtree"));
+    memoize(big);
+    Json from = Members().set("big", big).set("small", number(1)).build();
+    Json to;
+    ASSERT_THAT(apply_patch(from, diff(from, Members().set("big", big).build()), &to), Eq(true));
+
+    // The untouched member still shares its node (and so its memoized serialization).
+    EXPECT_THAT(member(to, "big").serialized(), Eq(big.serialized()));
+    EXPECT_THAT(member(to, "big").serialized(), NotNull());
+}
+
+Json operation(const char* op, const char* path, const Json& value = Json()) {
+    return Members().set("op", string(op)).set("path", string(path)).set("value", value).build();
+}
+
+Json from_operation(const char* op, const char* from, const char* path) {
+    return Members().set("op", string(op)).set("from", string(from)).set("path", string(path))
+        .build();
+}
+
+TEST_F(PatchTest, ApplyTest) {
+    Json doc = Members()
+        .set("a", array(number(1), number(2)))
+        .set("b", Members().set("c", number(3)).build())
+        .build();
+    Json result;
+
+    ASSERT_THAT(apply_patch(doc, array(operation("add", "/a/-", number(9))), &result), Eq(true));
+    EXPECT_THAT(serialize(result), Eq(String("{\"a\":[1,2,9],\"b\":{\"c\":3}}")));
+
+    ASSERT_THAT(apply_patch(doc, array(operation("add", "/a/0", number(0))), &result), Eq(true));
+    EXPECT_THAT(serialize(result), Eq(String("{\"a\":[0,1,2],\"b\":{\"c\":3}}")));
+
+    ASSERT_THAT(apply_patch(doc, array(from_operation("move", "/b/c", "/d")), &result), Eq(true));
+    EXPECT_THAT(serialize(result), Eq(String("{\"a\":[1,2],\"b\":{},\"d\":3}")));
+
+    ASSERT_THAT(apply_patch(doc, array(from_operation("copy", "/a", "/b/e")), &result), Eq(true));
+    EXPECT_THAT(serialize(result), Eq(String("{\"a\":[1,2],\"b\":{\"c\":3,\"e\":[1,2]}}")));
+
+    ASSERT_THAT(apply_patch(doc, array(
+                    operation("test", "/b/c", number(3)),
+                    operation("replace", "", number(4))), &result), Eq(true));
+    EXPECT_THAT(serialize(result), Eq(String("4")));
+
+    ASSERT_THAT(apply_patch(doc, array(operation("remove", "/a/1")), &result), Eq(true));
+    EXPECT_THAT(serialize(result), Eq(String("{\"a\":[1],\"b\":{\"c\":3}}")));
+}
+
+TEST_F(PatchTest, FailureTest) {
+    Json doc = Members()
+        .set("a", array(number(1), number(2)))
+        .set("b", Members().set("c", number(3)).build())
+        .build();
+    const Json failures[] = {
+        operation("test", "/b/c", number(4)),
+        operation("replace", "/b/d", number(4)),
+        operation("remove", "/a/2"),
+        operation("remove", "/a/01"),
+        operation("remove", "/a/-"),
+        operation("add", "/a/3", number(4)),
+        operation("add", "/x/y", number(4)),
+        operation("add", "a", number(4)),
+        operation("add", "/~2", number(4)),
+        operation("remove", ""),
+        operation("frobnicate", "/a"),
+        from_operation("move", "/b", "/b/c"),
+        from_operation("copy", "/z", "/b"),
+        Members().set("op", string("add")).set("path", string("/q")).build(),
+        number(1),
+    };
+    for (size_t i = 0; i < sizeof(failures) / sizeof(failures[0]); ++i) {
+        Json result = number(99);
+        EXPECT_THAT(apply_patch(doc, array(failures[i]), &result), Eq(false))
+            << "failure " << i;
+        EXPECT_THAT(serialize(result), Eq(String("99")));
+    }
+    Json result = number(99);
+    EXPECT_THAT(apply_patch(doc, Members().build(), &result), Eq(false));
+}
+
+}  // namespace
+}  // namespace rgos
@@ -0,0 +1,191 @@
+// Copyright (c) 2009 Chris Pickel <sfiera@gmail.com>
+//
+// This file is part of librgos, a free software project.  You can redistribute it and/or modify it
+// under the terms of the MIT License.
+
+#include "rgos/Serialize.hpp"
+
+#include <algorithm>
+#include <vector>
+#include <sfz/sfz.hpp>
+#include "rgos/ByteSink.hpp"
+#include "rgos/Json.hpp"
+#include "Bench.hpp"
+
+using sfz::String;
+using std::vector;
+
+namespace rgos {
+namespace {
+
+void bench_print(BenchState* state, const Json& json) {
+    state->bytes = String(json).size();
+    state->start();
+    for (size_t i = 0; i < state->iterations; ++i) {
+        String out;
+        print_to(&out, json);
+    }
+}
+
+void bench_pretty_print(
+        BenchState* state, const Json& json, const PrettyPrintStyle& style = PrettyPrintStyle()) {
+    state->bytes = String(pretty_print(json, style)).size();
+    state->start();
+    for (size_t i = 0; i < state->iterations; ++i) {
+        String out;
+        print_to(&out, pretty_print(json, style));
+    }
+}
+
+void bench_print_canonical(BenchState* state, const Json& json) {
+    state->bytes = String(canonical(json)).size();
+    state->start();
+    for (size_t i = 0; i < state->iterations; ++i) {
+        String out;
+        print_to(&out, canonical(json));
+    }
+}
+
+void bench_canonical_hash(BenchState* state, const Json& json) {
+    state->bytes = String(canonical(json)).size();
+    volatile uint64_t sink = 0;
+    state->start();
+    for (size_t i = 0; i < state->iterations; ++i) {
+        sink = sink + canonical_hash(json);
+    }
+}
+
+// Discards its input, accepting at most 64 KiB per call, like a socket with a typical buffer.
+class DiscardSink : public ByteSink {
+  public:
+    virtual bool write(const char* data, size_t size, size_t* written) {
+        *written = std::min<size_t>(size, 65536);
+        return true;
+    }
+};
+
+void bench_write(BenchState* state, const Json& json) {
+    state->bytes = String(json).size();
+    DiscardSink sink;
+    state->start();
+    for (size_t i = 0; i < state->iterations; ++i) {
+        JsonWriter writer(json);
+        while (writer.write(&sink) == JsonWriter::WOULD_BLOCK) { }
+    }
+}
+
+BENCHMARK(PrintNumberCorpus) { bench_print(state, number_corpus(1000)); }
+BENCHMARK(PrintStringCorpus) { bench_print(state, string_corpus(1000)); }
+BENCHMARK(PrintDeepCorpus) { bench_print(state, deep_corpus(1000)); }
+BENCHMARK(PrintWideCorpus) { bench_print(state, wide_corpus(1000)); }
+
+BENCHMARK(PrintDeep100k) { bench_print(state, deep_corpus(100000)); }
+BENCHMARK(PrintWideShallow100k) { bench_print(state, wide_corpus(100000)); }
+
+BENCHMARK(PrintCanonicalNumberCorpus) { bench_print_canonical(state, number_corpus(1000)); }
+BENCHMARK(PrintCanonicalStringCorpus) { bench_print_canonical(state, string_corpus(1000)); }
+BENCHMARK(CanonicalHashNumberCorpus) { bench_canonical_hash(state, number_corpus(1000)); }
+BENCHMARK(CanonicalHashStringCorpus) { bench_canonical_hash(state, string_corpus(1000)); }
+
+BENCHMARK(WriteNumberCorpus) { bench_write(state, number_corpus(1000)); }
+BENCHMARK(WriteStringCorpus) { bench_write(state, string_corpus(1000)); }
+
+// {"id": 1234, "ok": true, "name": "record"}
+vector<Json> small_records(size_t count) {
+    vector<Json> records;
+    for (size_t i = 0; i < count; ++i) {
+        StringMap<Json> record;
+        record.insert(std::make_pair(sfz::StringSlice("id"), Json::number(i)));
+        record.insert(std::make_pair(sfz::StringSlice("ok"), Json::bool_(true)));
+        record.insert(std::make_pair(sfz::StringSlice("name"), Json::string("record")));
+        records.push_back(Json::object(record));
+    }
+    return records;
+}
+
+// One print_to() per record, as NDJSON output was written before NdjsonWriter.
+BENCHMARK(NdjsonPrintSmallRecords) {
+    const vector<Json> records = small_records(10000);
+    state->items = records.size();
+    state->start();
+    for (size_t i = 0; i < state->iterations; ++i) {
+        foreach (const Json& record, records) {
+            String line;
+            print_to(&line, record);
+            line.push(1, '\n');
+        }
+    }
+}
+
+BENCHMARK(NdjsonWriteSmallRecords) {
+    const vector<Json> records = small_records(10000);
+    DiscardSink sink;
+    NdjsonWriter writer(&sink);
+    state->items = records.size();
+    state->start();
+    for (size_t i = 0; i < state->iterations; ++i) {
+        writer.write(records);
+    }
+    writer.flush();
+}
+
+BENCHMARK(PrettyPrintNumberCorpus) { bench_pretty_print(state, number_corpus(1000)); }
+BENCHMARK(PrettyPrintStringCorpus) { bench_pretty_print(state, string_corpus(1000)); }
+BENCHMARK(PrettyPrintDeepCorpus) { bench_pretty_print(state, deep_corpus(1000)); }
+BENCHMARK(PrettyPrintWideCorpus) { bench_pretty_print(state, wide_corpus(1000)); }
+
+BENCHMARK(PrettyPrintNumberCompact) {
+    PrettyPrintStyle style;
+    style.indent = 1;
+    style.tabs = true;
+    style.compact_arrays = 16;
+    bench_pretty_print(state, number_corpus(1000), style);
+}
+
+// A response that embeds one large static block, and one small dynamic value.
+Json make_response(const Json& block) {
+    vector<Json> response;
+    response.push_back(block);
+    response.push_back(Json::number(1.0));
+    return Json::array(response);
+}
+
+BENCHMARK(PrintStaticBlock) {
+    bench_print(state, make_response(wide_corpus(1000)));
+}
+
+BENCHMARK(PrintMemoizedStaticBlock) {
+    bench_print(state, make_response(memoize(wide_corpus(1000))));
+}
+
+// About 100M characters of output, from a small tree that repeats one subtree.
+Json large_corpus() {
+    vector<Json> blocks(1700, string_corpus(1000));
+    return Json::array(blocks);
+}
+
+BENCHMARK(PrintLarge) {
+    bench_print(state, large_corpus());
+}
+
+BENCHMARK(PrintLargeReserved) {
+    Json json = large_corpus();
+    state->bytes = serialized_size(json);
+    state->start();
+    for (size_t i = 0; i < state->iterations; ++i) {
+        String out;
+        append_json(&out, json);
+    }
+}
+
+BENCHMARK(MeasureLarge) {
+    Json json = large_corpus();
+    state->bytes = serialized_size(json);
+    state->start();
+    for (size_t i = 0; i < state->iterations; ++i) {
+        serialized_size(json);
+    }
+}
+
+}  // namespace
+}  // namespace rgos
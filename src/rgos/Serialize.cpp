@@ -6,14 +6,25 @@
 #include "rgos/Serialize.hpp"
 
 #include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <algorithm>
+#include <vector>
 #include <sfz/sfz.hpp>
+#include "rgos/ByteSink.hpp"
 #include "rgos/Json.hpp"
 #include "rgos/JsonVisitor.hpp"
+#include "rgos/JsonWalker.hpp"
+#include "rgos/Stats.hpp"
+#include "rgos/Utf8.hpp"
+#include "rgos/Xxh64.hpp"
 
 using sfz::PrintItem;
 using sfz::PrintTarget;
+using sfz::Rune;
 using sfz::StringSlice;
-using sfz::quote;
+using sfz::scoped_ptr;
 using std::map;
 using std::vector;
 
@@ -21,16 +32,129 @@ namespace rgos {
 
 namespace {
 
-class SerializerVisitor : public JsonVisitor {
+// Characters that must be escaped inside a JSON string.
+inline bool needs_escape(Rune r) {
+    return (r < 0x20) || (r == '"') || (r == '\\');
+}
+
+// Writes `value` as a quoted JSON string.  Runs of characters that need no escaping are pushed
+// as single slices, so a typical string costs two or three calls on `out`.
+void write_string(PrintTarget out, const StringSlice& value) {
+    static const char kHex[] = "0123456789abcdef";
+    out.push(1, '"');
+    size_t run_start = 0;
+    for (size_t i = 0; i < value.size(); ++i) {
+        const Rune r = value.at(i);
+        if (!needs_escape(r)) {
+            continue;
+        }
+        if (i > run_start) {
+            out.push(value.slice(run_start, i - run_start));
+        }
+        run_start = i + 1;
+        switch (r) {
+          case '"': out.push("\\\""); break;
+          case '\\': out.push("\\\\"); break;
+          case '\b': out.push("\\b"); break;
+          case '\f': out.push("\\f"); break;
+          case '\n': out.push("\\n"); break;
+          case '\r': out.push("\\r"); break;
+          case '\t': out.push("\\t"); break;
+          default:
+            out.push("\\u00");
+            out.push(1, kHex[r >> 4]);
+            out.push(1, kHex[r & 0xf]);
+            break;
+        }
+    }
+    if (value.size() > run_start) {
+        out.push(value.slice(run_start, value.size() - run_start));
+    }
+    out.push(1, '"');
+}
+
+// Writes `value` with the fewest significant digits that read back as `value`.  Integers up to
+// 2^53, all of which are exact, are written in full instead of with an exponent.  Every double is
+// exactly representable in 17 digits, and one that is representable in fewer is printed that way
+// by %.15g, which drops trailing zeros, so at most three lengths need to be tried.  Subnormals
+// have less precision than that, so for them every length is tried.
+void write_canonical_number(PrintTarget out, double value) {
+    char buffer[40];
+    if ((value != value) || (value - value != 0)) {
+        out.push("null");  // NaN or infinite.
+        return;
+    } else if (value == 0) {
+        out.push(1, '0');  // Also -0.
+        return;
+    } else if ((floor(value) == value) && (fabs(value) <= 9007199254740992.0)) {
+        snprintf(buffer, sizeof(buffer), "%.0f", value);
+    } else {
+        const bool subnormal = fabs(value) < 2.2250738585072014e-308;
+        for (int digits = subnormal ? 1 : 15; digits <= 17; ++digits) {
+            snprintf(buffer, sizeof(buffer), "%.*g", digits, value);
+            if (strtod(buffer, NULL) == value) {
+                break;
+            }
+        }
+    }
+
+    // Write exponents as "e21" and "e-7", not "e+21" and "e-07".
+    const char* exponent = strchr(buffer, 'e');
+    if (!exponent) {
+        out.push(buffer);
+        return;
+    }
+    out.push(StringSlice(buffer).slice(0, exponent - buffer + 1));
+    ++exponent;
+    if (*exponent == '+') {
+        ++exponent;
+    } else if (*exponent == '-') {
+        out.push(1, '-');
+        ++exponent;
+    }
+    while ((exponent[0] == '0') && (exponent[1] != '\0')) {
+        ++exponent;
+    }
+    out.push(exponent);
+}
+
+class ScalarCheck : public JsonDefaultVisitor {
+  public:
+    ScalarCheck() : scalar(true) { }
+    virtual void visit_object(const StringMap<Json>& value) { scalar = false; }
+    virtual void visit_array(const vector<Json>& value) { scalar = false; }
+    virtual void visit_default(const char* type) { }
+    bool scalar;
+};
+
+bool all_scalars(const vector<Json>& values) {
+    foreach (const Json& value, values) {
+        ScalarCheck check;
+        value.accept(&check);
+        if (!check.scalar) {
+            return false;
+        }
+    }
+    return true;
+}
+
+class SerializerVisitor : public JsonEventVisitor {
   public:
     explicit SerializerVisitor(PrintTarget out);
 
-    virtual void visit_object(const StringMap<Json>& value);
-    virtual void visit_array(const vector<Json>& value);
-    virtual void visit_string(const StringSlice& value);
-    virtual void visit_number(double value);
-    virtual void visit_bool(bool value);
-    virtual void visit_null();
+    // Copies memoized serializations instead of walking the subtree.
+    virtual Action enter_value(const Json& value);
+
+    virtual Action begin_object(const StringMap<Json>& value);
+    virtual Action object_key(const StringSlice& key, size_t index);
+    virtual Action end_object(const StringMap<Json>& value);
+    virtual Action begin_array(const vector<Json>& value);
+    virtual Action array_element(size_t index);
+    virtual Action end_array(const vector<Json>& value);
+    virtual Action visit_string(const StringSlice& value);
+    virtual Action visit_number(double value);
+    virtual Action visit_bool(bool value);
+    virtual Action visit_null();
 
   protected:
     PrintTarget _out;
@@ -39,15 +163,44 @@ class SerializerVisitor : public JsonVisitor {
     DISALLOW_COPY_AND_ASSIGN(SerializerVisitor);
 };
 
+class CanonicalVisitor : public SerializerVisitor {
+  public:
+    explicit CanonicalVisitor(PrintTarget out);
+
+    // Memoized serializations may not be canonical, so they are never used here.
+    virtual Action enter_value(const Json& value);
+
+    virtual Action visit_number(double value);
+
+  private:
+    DISALLOW_COPY_AND_ASSIGN(CanonicalVisitor);
+};
+
 class PrettyPrinterVisitor : public SerializerVisitor {
   public:
-    explicit PrettyPrinterVisitor(PrintTarget out);
+    PrettyPrinterVisitor(PrintTarget out, const PrettyPrintStyle& style);
 
-    virtual void visit_object(const StringMap<Json>& value);
-    virtual void visit_array(const vector<Json>& value);
+    // Memoized serializations are compact, so they are never used here.
+    virtual Action enter_value(const Json& value);
+
+    virtual Action begin_object(const StringMap<Json>& value);
+    virtual Action object_key(const StringSlice& key, size_t index);
+    virtual Action end_object(const StringMap<Json>& value);
+    virtual Action begin_array(const vector<Json>& value);
+    virtual Action array_element(size_t index);
+    virtual Action end_array(const vector<Json>& value);
 
   private:
-    int _depth;
+    void newline();
+
+    const PrettyPrintStyle _style;
+    size_t _depth;
+    bool _compact;  // Inside an array that is being printed on one line.
+
+    // A newline followed by indentation for _indent_levels levels.  newline() writes a prefix
+    // of it, extending it first if necessary.
+    sfz::String _indent;
+    size_t _indent_levels;
 
     DISALLOW_COPY_AND_ASSIGN(PrettyPrinterVisitor);
 };
@@ -55,121 +208,548 @@ class PrettyPrinterVisitor : public SerializerVisitor {
 SerializerVisitor::SerializerVisitor(PrintTarget out)
     : _out(out) { }
 
-void SerializerVisitor::visit_object(const StringMap<Json>& value) {
+SerializerVisitor::Action SerializerVisitor::enter_value(const Json& value) {
+    const sfz::String* serialized = value.serialized();
+    if (serialized) {
+        _out.push(*serialized);
+        return SKIP;
+    }
+    return CONTINUE;
+}
+
+SerializerVisitor::Action SerializerVisitor::begin_object(const StringMap<Json>& value) {
     _out.push(1, '{');
-    if (value.size() > 0) {
-        bool first = true;
-        foreach (const StringMap<Json>::value_type& item, value) {
-            if (first) {
-                first = false;
-            } else {
-                _out.push(1, ',');
-            }
-            print_to(_out, quote(item.first));
-            _out.push(1, ':');
-            item.second.accept(this);
-        }
+    return CONTINUE;
+}
+
+SerializerVisitor::Action SerializerVisitor::object_key(const StringSlice& key, size_t index) {
+    if (index > 0) {
+        _out.push(1, ',');
     }
+    write_string(_out, key);
+    _out.push(1, ':');
+    return CONTINUE;
+}
+
+SerializerVisitor::Action SerializerVisitor::end_object(const StringMap<Json>& value) {
     _out.push(1, '}');
+    return CONTINUE;
 }
 
-void SerializerVisitor::visit_array(const vector<Json>& value) {
+SerializerVisitor::Action SerializerVisitor::begin_array(const vector<Json>& value) {
     _out.push(1, '[');
-    if (value.size() > 0) {
-        bool first = true;
-        foreach (const Json& item, value) {
-            if (first) {
-                first = false;
-            } else {
-                _out.push(1, ',');
-            }
-            item.accept(this);
-        }
+    return CONTINUE;
+}
+
+SerializerVisitor::Action SerializerVisitor::array_element(size_t index) {
+    if (index > 0) {
+        _out.push(1, ',');
     }
+    return CONTINUE;
+}
+
+SerializerVisitor::Action SerializerVisitor::end_array(const vector<Json>& value) {
     _out.push(1, ']');
+    return CONTINUE;
 }
 
-void SerializerVisitor::visit_string(const StringSlice& value) {
-    print_to(_out, quote(value));
+SerializerVisitor::Action SerializerVisitor::visit_string(const StringSlice& value) {
+    write_string(_out, value);
+    return CONTINUE;
 }
 
-void SerializerVisitor::visit_number(double value) {
+SerializerVisitor::Action SerializerVisitor::visit_number(double value) {
     PrintItem(value).print_to(_out);
+    return CONTINUE;
 }
 
-void SerializerVisitor::visit_bool(bool value) {
+SerializerVisitor::Action SerializerVisitor::visit_bool(bool value) {
     PrintItem(value).print_to(_out);
+    return CONTINUE;
 }
 
-void SerializerVisitor::visit_null() {
+SerializerVisitor::Action SerializerVisitor::visit_null() {
     _out.push("null");
+    return CONTINUE;
+}
+
+CanonicalVisitor::CanonicalVisitor(PrintTarget out)
+    : SerializerVisitor(out) { }
+
+CanonicalVisitor::Action CanonicalVisitor::enter_value(const Json& value) {
+    return CONTINUE;
+}
+
+CanonicalVisitor::Action CanonicalVisitor::visit_number(double value) {
+    write_canonical_number(_out, value);
+    return CONTINUE;
 }
 
-PrettyPrinterVisitor::PrettyPrinterVisitor(PrintTarget out)
+PrettyPrinterVisitor::PrettyPrinterVisitor(PrintTarget out, const PrettyPrintStyle& style)
     : SerializerVisitor(out),
-      _depth(0) { }
+      _style(style),
+      _depth(0),
+      _compact(false),
+      _indent("\n"),
+      _indent_levels(0) { }
 
-void PrettyPrinterVisitor::visit_object(const StringMap<Json>& value) {
+PrettyPrinterVisitor::Action PrettyPrinterVisitor::enter_value(const Json& value) {
+    return CONTINUE;
+}
+
+PrettyPrinterVisitor::Action PrettyPrinterVisitor::begin_object(const StringMap<Json>& value) {
     _out.push(1, '{');
-    if (value.size() > 0) {
-        _depth += 2;
-        bool first = true;
-        foreach (const StringMap<Json>::value_type& item, value) {
-            if (first) {
-                first = false;
-            } else {
-                _out.push(1, ',');
-            }
-            _out.push(1, '\n');
-            _out.push(_depth, ' ');
-            print_to(_out, quote(item.first));
-            _out.push(": ");
-            item.second.accept(this);
-        }
-        _depth -= 2;
-        _out.push(1, '\n');
-        _out.push(_depth, ' ');
+    ++_depth;
+    return CONTINUE;
+}
+
+PrettyPrinterVisitor::Action PrettyPrinterVisitor::object_key(
+        const StringSlice& key, size_t index) {
+    if (index > 0) {
+        _out.push(1, ',');
+    }
+    newline();
+    write_string(_out, key);
+    _out.push(": ");
+    return CONTINUE;
+}
+
+PrettyPrinterVisitor::Action PrettyPrinterVisitor::end_object(const StringMap<Json>& value) {
+    --_depth;
+    if (!value.empty()) {
+        newline();
     }
     _out.push(1, '}');
+    return CONTINUE;
 }
 
-void PrettyPrinterVisitor::visit_array(const vector<Json>& value) {
+PrettyPrinterVisitor::Action PrettyPrinterVisitor::begin_array(const vector<Json>& value) {
     _out.push(1, '[');
-    if (value.size() > 0) {
-        _depth += 2;
-        bool first = true;
-        foreach (const Json& item, value) {
-            if (first) {
-                first = false;
-            } else {
-                _out.push(1, ',');
-            }
-            _out.push(1, '\n');
-            _out.push(_depth, ' ');
-            item.accept(this);
+    ++_depth;
+    _compact = (value.size() <= _style.compact_arrays) && all_scalars(value);
+    return CONTINUE;
+}
+
+PrettyPrinterVisitor::Action PrettyPrinterVisitor::array_element(size_t index) {
+    if (_compact) {
+        if (index > 0) {
+            _out.push(", ");
+        }
+    } else {
+        if (index > 0) {
+            _out.push(1, ',');
         }
-        _depth -= 2;
-        _out.push(1, '\n');
-        _out.push(_depth, ' ');
+        newline();
+    }
+    return CONTINUE;
+}
+
+PrettyPrinterVisitor::Action PrettyPrinterVisitor::end_array(const vector<Json>& value) {
+    --_depth;
+    if (_compact) {
+        _compact = false;
+    } else if (!value.empty()) {
+        newline();
     }
     _out.push(1, ']');
+    return CONTINUE;
 }
 
+void PrettyPrinterVisitor::newline() {
+    if (_depth > _indent_levels) {
+        size_t levels = std::max(_depth, 2 * _indent_levels);
+        _indent.push((levels - _indent_levels) * _style.indent, _style.tabs ? '\t' : ' ');
+        _indent_levels = levels;
+    }
+    _out.push(StringSlice(_indent).slice(0, 1 + (_depth * _style.indent)));
+}
+
+// Discards output, counting how much there was.
+class SizeTarget {
+  public:
+    SizeTarget() : size(0) { }
+
+    void push(const StringSlice& string) { size += string.size(); }
+    void push(size_t num, Rune rune) { size += num; }
+
+    size_t size;
+
+  private:
+    DISALLOW_COPY_AND_ASSIGN(SizeTarget);
+};
+
+#ifdef RGOS_STATS
+
+// Forwards output to another PrintTarget, and on destruction records the number of characters
+// passed through and the time elapsed since construction.
+class StatsTarget {
+  public:
+    explicit StatsTarget(PrintTarget out)
+        : _out(out),
+          _chars(0),
+          _start_usecs(now_usecs()) { }
+
+    ~StatsTarget() {
+        RGOS_STATS_ADD(serializations, 1);
+        RGOS_STATS_ADD(serialized_chars, _chars);
+        RGOS_STATS_ADD(serialize_usecs, now_usecs() - _start_usecs);
+    }
+
+    void push(const StringSlice& string) {
+        _chars += string.size();
+        _out.push(string);
+    }
+
+    void push(size_t num, Rune rune) {
+        _chars += num;
+        _out.push(num, rune);
+    }
+
+  private:
+    static int64_t now_usecs() {
+        timeval tv;
+        gettimeofday(&tv, NULL);
+        return tv.tv_sec * 1000000ll + tv.tv_usec;
+    }
+
+    PrintTarget _out;
+    uint64_t _chars;
+    const int64_t _start_usecs;
+
+    DISALLOW_COPY_AND_ASSIGN(StatsTarget);
+};
+
+#endif  // RGOS_STATS
+
+// Encodes output as UTF-8 onto the end of a byte buffer.
+class Utf8Target {
+  public:
+    explicit Utf8Target(vector<char>* bytes) : _bytes(bytes) { }
+
+    void push(const StringSlice& string) {
+        for (size_t i = 0; i < string.size(); ++i) {
+            const Rune rune = string.at(i);
+            if (rune < 0x80) {
+                _bytes->push_back(rune);
+            } else {
+                push(1, rune);
+            }
+        }
+    }
+
+    void push(size_t num, Rune rune) {
+        char encoded[4];
+        const size_t size = encode_utf8(rune, encoded);
+        for (size_t i = 0; i < num; ++i) {
+            _bytes->insert(_bytes->end(), encoded, encoded + size);
+        }
+    }
+
+  private:
+    vector<char>* const _bytes;
+
+    DISALLOW_COPY_AND_ASSIGN(Utf8Target);
+};
+
+// Encodes output as UTF-8 and hashes it, passing it to the hasher a buffer at a time.
+class HashTarget {
+  public:
+    explicit HashTarget(uint64_t seed)
+        : _hasher(seed),
+          _size(0) { }
+
+    void push(const StringSlice& string) {
+        for (size_t i = 0; i < string.size(); ++i) {
+            push_rune(string.at(i));
+        }
+    }
+
+    void push(size_t num, Rune rune) {
+        for (size_t i = 0; i < num; ++i) {
+            push_rune(rune);
+        }
+    }
+
+    uint64_t digest() {
+        _hasher.update(_buffer, _size);
+        _size = 0;
+        return _hasher.digest();
+    }
+
+  private:
+    void push_rune(Rune rune) {
+        if (_size > (sizeof(_buffer) - 4)) {
+            _hasher.update(_buffer, _size);
+            _size = 0;
+        }
+        if (rune < 0x80) {
+            _buffer[_size++] = rune;
+        } else {
+            _size += encode_utf8(rune, _buffer + _size);
+        }
+    }
+
+    Xxh64 _hasher;
+    char _buffer[256];
+    size_t _size;
+
+    DISALLOW_COPY_AND_ASSIGN(HashTarget);
+};
+
 }  // namespace
 
+PrettyPrintStyle::PrettyPrintStyle()
+    : indent(2),
+      tabs(false),
+      compact_arrays(0) { }
+
 JsonPrettyPrinter pretty_print(const Json& value) {
-    JsonPrettyPrinter result = { value };
+    JsonPrettyPrinter result = { value, PrettyPrintStyle() };
+    return result;
+}
+
+JsonPrettyPrinter pretty_print(const Json& value, const PrettyPrintStyle& style) {
+    JsonPrettyPrinter result = { value, style };
     return result;
 }
 
 void print_to(sfz::PrintTarget out, const Json& json) {
+#ifdef RGOS_STATS
+    StatsTarget stats(out);
+    out = &stats;
+#endif
     SerializerVisitor visitor(out);
-    json.accept(&visitor);
+    walk(json, &visitor);
+}
+
+JsonCanonicalPrinter canonical(const Json& value) {
+    JsonCanonicalPrinter result = { value };
+    return result;
+}
+
+void print_to(sfz::PrintTarget out, const JsonCanonicalPrinter& json) {
+#ifdef RGOS_STATS
+    StatsTarget stats(out);
+    out = &stats;
+#endif
+    CanonicalVisitor visitor(out);
+    walk(json.json, &visitor);
+}
+
+uint64_t canonical_hash(const Json& json, uint64_t seed) {
+    HashTarget target(seed);
+    PrintTarget out(&target);
+#ifdef RGOS_STATS
+    StatsTarget stats(out);
+    out = &stats;
+#endif
+    CanonicalVisitor visitor(out);
+    walk(json, &visitor);
+    return target.digest();
 }
 
 void print_to(sfz::PrintTarget out, const JsonPrettyPrinter& json) {
-    PrettyPrinterVisitor visitor(out);
-    json.json.accept(&visitor);
+#ifdef RGOS_STATS
+    StatsTarget stats(out);
+    out = &stats;
+#endif
+    PrettyPrinterVisitor visitor(out, json.style);
+    walk(json.json, &visitor);
+}
+
+size_t serialized_size(const Json& json) {
+    SizeTarget target;
+    SerializerVisitor visitor(&target);
+    walk(json, &visitor);
+    return target.size;
+}
+
+size_t serialized_size(const JsonPrettyPrinter& json) {
+    SizeTarget target;
+    PrettyPrinterVisitor visitor(&target, json.style);
+    walk(json.json, &visitor);
+    return target.size;
+}
+
+void append_json(sfz::String* out, const Json& json) {
+    out->reserve(out->size() + serialized_size(json));
+    print_to(out, json);
+}
+
+void append_json(sfz::String* out, const JsonPrettyPrinter& json) {
+    out->reserve(out->size() + serialized_size(json));
+    print_to(out, json);
+}
+
+class JsonWriter::State {
+  public:
+    State(const Json& json, size_t chunk_size)
+        : walker(json),
+          target(&bytes),
+          chunk_size(std::max<size_t>(chunk_size, 1)),
+          sent(0),
+          failed(false) { }
+
+    // The target for `visitor`, which appends to `bytes`.
+    PrintTarget out() {
+#ifdef RGOS_STATS
+        stats.reset(new StatsTarget(&target));
+        return stats.get();
+#else
+        return &target;
+#endif
+    }
+
+    JsonWalker walker;
+    scoped_ptr<SerializerVisitor> visitor;
+    vector<char> bytes;  // The current chunk.
+    Utf8Target target;   // Appends to `bytes`.
+#ifdef RGOS_STATS
+    scoped_ptr<StatsTarget> stats;  // Between `visitor` and `target` until the walk completes.
+#endif
+    const size_t chunk_size;
+    size_t sent;         // The number of bytes at the start of `bytes` already written.
+    bool failed;
+
+  private:
+    DISALLOW_COPY_AND_ASSIGN(State);
+};
+
+JsonWriter::JsonWriter(const Json& json, size_t chunk_size)
+    : _state(new State(json, chunk_size)) {
+    _state->visitor.reset(new SerializerVisitor(_state->out()));
+}
+
+JsonWriter::JsonWriter(const JsonPrettyPrinter& json, size_t chunk_size)
+    : _state(new State(json.json, chunk_size)) {
+    _state->visitor.reset(new PrettyPrinterVisitor(_state->out(), json.style));
+}
+
+JsonWriter::~JsonWriter() { }
+
+JsonWriter::Status JsonWriter::write(ByteSink* sink) {
+    State& state = *_state;
+    while (!state.failed) {
+        if (state.sent == state.bytes.size()) {
+            state.bytes.clear();
+            state.sent = 0;
+            while (!state.walker.done() && (state.bytes.size() < state.chunk_size)) {
+                state.walker.step(state.visitor.get());
+            }
+            if (state.bytes.empty()) {
+#ifdef RGOS_STATS
+                state.stats.reset();  // Records the serialization.
+#endif
+                return COMPLETE;
+            }
+        }
+
+        size_t written;
+        if (!sink->write(&state.bytes[state.sent], state.bytes.size() - state.sent, &written)) {
+            state.failed = true;
+            break;
+        }
+        state.sent += written;
+        if (state.sent < state.bytes.size()) {
+            return WOULD_BLOCK;
+        }
+    }
+    return SINK_ERROR;
+}
+
+class NdjsonWriter::State {
+  public:
+    State(ByteSink* sink, size_t flush_size)
+        : sink(sink),
+          target(&bytes),
+          walker(Json()),
+          flush_size(flush_size),
+          sent(0),
+          failed(false) { }
+
+    ByteSink* const sink;
+    vector<char> bytes;  // Pending output, after the first `sent` bytes.
+    Utf8Target target;   // Appends to `bytes`.
+    JsonWalker walker;   // Reset for each record, so that its stack is allocated only once.
+    const size_t flush_size;
+    size_t sent;
+    bool failed;
+
+  private:
+    DISALLOW_COPY_AND_ASSIGN(State);
+};
+
+NdjsonWriter::NdjsonWriter(ByteSink* sink, size_t flush_size)
+    : _state(new State(sink, flush_size)) { }
+
+NdjsonWriter::~NdjsonWriter() { }
+
+bool NdjsonWriter::write(const Json& value) {
+    State& state = *_state;
+    if (state.failed) {
+        return false;
+    }
+    {
+        PrintTarget out(&state.target);
+#ifdef RGOS_STATS
+        StatsTarget stats(out);
+        out = &stats;
+#endif
+        SerializerVisitor visitor(out);
+        state.walker.reset(value);
+        while (state.walker.step(&visitor)) { }
+    }
+    state.bytes.push_back('\n');
+    if (pending() >= state.flush_size) {
+        return flush() != JsonWriter::SINK_ERROR;
+    }
+    return true;
+}
+
+bool NdjsonWriter::write(const vector<Json>& values) {
+    foreach (const Json& value, values) {
+        if (!write(value)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+JsonWriter::Status NdjsonWriter::flush() {
+    State& state = *_state;
+    if (state.failed) {
+        return JsonWriter::SINK_ERROR;
+    } else if (pending() > 0) {
+        size_t written;
+        if (!state.sink->write(&state.bytes[state.sent], pending(), &written)) {
+            state.failed = true;
+            return JsonWriter::SINK_ERROR;
+        }
+        state.sent += written;
+        if (pending() > 0) {
+            // Drop what was sent, so that a sink which keeps filling up doesn't keep the
+            // buffer growing.
+            if (state.sent >= state.flush_size) {
+                state.bytes.erase(state.bytes.begin(), state.bytes.begin() + state.sent);
+                state.sent = 0;
+            }
+            return JsonWriter::WOULD_BLOCK;
+        }
+    }
+    state.bytes.clear();
+    state.sent = 0;
+    return JsonWriter::COMPLETE;
+}
+
+size_t NdjsonWriter::pending() const {
+    return _state->bytes.size() - _state->sent;
+}
+
+const Json& memoize(const Json& json) {
+    if (!json.serialized()) {
+        json.set_serialized(new sfz::String(json));
+    }
+    return json;
 }
 
 }  // namespace rgos
@@ -5,16 +5,24 @@
 
 #include "rgos/Serialize.hpp"
 
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <string>
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 #include <sfz/sfz.hpp>
+#include "rgos/ByteSink.hpp"
 #include "rgos/Json.hpp"
+#include "rgos/Utf8.hpp"
+#include "rgos/Xxh64.hpp"
 
 using sfz::CString;
 using sfz::StringSlice;
 using sfz::format;
 using std::make_pair;
 using std::map;
+using std::string;
 using std::vector;
 using testing::Eq;
 using testing::InSequence;
@@ -43,6 +51,18 @@ TEST_F(SerializeTest, StringTest) {
     EXPECT_THAT(Json::string(""), SerializesTo("\"\""));
     EXPECT_THAT(Json::string("Hello, world!"), SerializesTo("\"Hello, world!\""));
     EXPECT_THAT(Json::string("Multiple\nLines"), SerializesTo("\"Multiple\\nLines\""));
+    EXPECT_THAT(Json::string("\"quoted\" \\ back"),
+                SerializesTo("\"\\\"quoted\\\" \\\\ back\""));
+    EXPECT_THAT(Json::string("tab\there\r\n"), SerializesTo("\"tab\\there\\r\\n\""));
+    EXPECT_THAT(Json::string("\b\f\x01\x1f "), SerializesTo("\"\\b\\f\\u0001\\u001f \""));
+
+    // Non-ASCII characters are written unescaped.
+    sfz::String accented("caf");
+    accented.push(1, 0xe9);
+    sfz::String expected("\"caf");
+    expected.push(1, 0xe9);
+    expected.push(1, '"');
+    EXPECT_THAT(Json::string(accented), SerializesTo(expected));
 }
 
 TEST_F(SerializeTest, NumberTest) {
@@ -149,5 +169,360 @@ TEST_F(SerializeTest, ComplexObjectTest) {
                     151.0, 213.0, 281.0)));
 }
 
+TEST_F(SerializeTest, PrettyPrintTest) {
+    vector<Json> a;
+    a.push_back(Json::number(1.0));
+    a.push_back(Json::number(2.0));
+    StringMap<Json> o;
+    o.insert(make_pair("array", Json::array(a)));
+    o.insert(make_pair("empty", Json::array(vector<Json>())));
+    Json object = Json::object(o);
+
+    EXPECT_THAT(pretty_print(object), SerializesTo(format(
+                "{{\n"
+                "  \"array\": [\n"
+                "    {0},\n"
+                "    {1}\n"
+                "  ],\n"
+                "  \"empty\": []\n"
+                "}}",
+                1.0, 2.0)));
+
+    PrettyPrintStyle style;
+    style.indent = 1;
+    style.tabs = true;
+    EXPECT_THAT(pretty_print(object, style), SerializesTo(format(
+                "{{\n"
+                "\t\"array\": [\n"
+                "\t\t{0},\n"
+                "\t\t{1}\n"
+                "\t],\n"
+                "\t\"empty\": []\n"
+                "}}",
+                1.0, 2.0)));
+
+    style.indent = 4;
+    style.tabs = false;
+    style.compact_arrays = 2;
+    EXPECT_THAT(pretty_print(object, style), SerializesTo(format(
+                "{{\n"
+                "    \"array\": [{0}, {1}],\n"
+                "    \"empty\": []\n"
+                "}}",
+                1.0, 2.0)));
+
+    // Too long, or containing a container: not compacted.
+    style.compact_arrays = 1;
+    vector<Json> nested;
+    nested.push_back(Json::array(vector<Json>()));
+    EXPECT_THAT(pretty_print(Json::array(a), style), SerializesTo(format(
+                "[\n"
+                "    {0},\n"
+                "    {1}\n"
+                "]",
+                1.0, 2.0)));
+    EXPECT_THAT(pretty_print(Json::array(nested), style), SerializesTo(
+                "[\n"
+                "    []\n"
+                "]"));
+}
+
+TEST_F(SerializeTest, SizeTest) {
+    vector<Json> a;
+    a.push_back(Json::string("Multiple\nLines"));
+    a.push_back(Json::number(1.0));
+    a.push_back(Json());
+    StringMap<Json> o;
+    o.insert(make_pair("one", Json::array(a)));
+    o.insert(make_pair("two", Json::bool_(false)));
+    o.insert(make_pair("three", Json::object(StringMap<Json>())));
+    Json object = Json::object(o);
+
+    EXPECT_THAT(serialized_size(object), Eq(sfz::String(object).size()));
+    EXPECT_THAT(serialized_size(pretty_print(object)),
+            Eq(sfz::String(pretty_print(object)).size()));
+    EXPECT_THAT(serialized_size(Json()), Eq(4u));
+
+    sfz::String out("prefix");
+    append_json(&out, object);
+    EXPECT_THAT(out, Eq(sfz::String(format("prefix{0}", object))));
+    append_json(&out, pretty_print(object));
+    EXPECT_THAT(out, Eq(sfz::String(format("prefix{0}{1}", object, pretty_print(object)))));
+
+    memoize(object);
+    EXPECT_THAT(serialized_size(object), Eq(object.serialized()->size()));
+}
+
+TEST_F(SerializeTest, MemoizeTest) {
+    StringMap<Json> o;
+    o.insert(make_pair("one", Json::number(1.0)));
+    o.insert(make_pair("two", Json::number(2.0)));
+    Json object = Json::object(o);
+    sfz::String expected(object);
+
+    EXPECT_THAT(object.serialized(), Eq<const sfz::String*>(NULL));
+    EXPECT_THAT(&memoize(object), Eq(&object));
+    ASSERT_THAT(object.serialized(), testing::NotNull());
+    EXPECT_THAT(*object.serialized(), Eq(expected));
+    const sfz::String* serialized = object.serialized();
+    memoize(object);
+    EXPECT_THAT(object.serialized(), Eq(serialized));
+
+    // Copies share the node, and so its memoized serialization.
+    Json copy = object;
+    EXPECT_THAT(copy.serialized(), Eq(serialized));
+
+    vector<Json> a;
+    a.push_back(object);
+    a.push_back(object);
+    EXPECT_THAT(Json::array(a), SerializesTo(format("[{0},{0}]", expected)));
+    EXPECT_THAT(pretty_print(object), SerializesTo(format(
+                "{{\n"
+                "  \"one\": {0},\n"
+                "  \"two\": {1}\n"
+                "}}",
+                1.0, 2.0)));
+
+    memoize(Json());
+    EXPECT_THAT(Json().serialized(), Eq<const sfz::String*>(NULL));
+}
+
+// Accepts at most `limit` bytes per call, and is full on every other call.
+class ThrottledSink : public ByteSink {
+  public:
+    explicit ThrottledSink(size_t limit) : _limit(limit), _full(false) { }
+
+    virtual bool write(const char* data, size_t size, size_t* written) {
+        _full = !_full;
+        *written = _full ? 0 : std::min(size, _limit);
+        bytes.append(data, *written);
+        return true;
+    }
+
+    string bytes;
+
+  private:
+    const size_t _limit;
+    bool _full;
+};
+
+class FailingSink : public ByteSink {
+  public:
+    virtual bool write(const char* data, size_t size, size_t* written) { return false; }
+};
+
+string utf8(const sfz::StringSlice& string) {
+    std::string result;
+    for (size_t i = 0; i < string.size(); ++i) {
+        char encoded[4];
+        result.append(encoded, encode_utf8(string.at(i), encoded));
+    }
+    return result;
+}
+
+Json writer_document() {
+    sfz::String accented("caf");
+    accented.push(1, 0xe9);
+    accented.push(1, 0x65e5);
+    vector<Json> elements;
+    for (int i = 0; i < 200; ++i) {
+        StringMap<Json> o;
+        o.insert(make_pair("index", Json::number(i)));
+        o.insert(make_pair("name", Json::string(accented)));
+        elements.push_back(Json::object(o));
+    }
+    return Json::array(elements);
+}
+
+TEST_F(SerializeTest, WriterTest) {
+    Json json = writer_document();
+    const string expected = utf8(sfz::String(json));
+
+    ThrottledSink sink(100);
+    JsonWriter writer(json, 64);
+    size_t blocked = 0;
+    JsonWriter::Status status;
+    while ((status = writer.write(&sink)) == JsonWriter::WOULD_BLOCK) {
+        ++blocked;
+    }
+    EXPECT_THAT(status, Eq(JsonWriter::COMPLETE));
+    EXPECT_THAT(sink.bytes, Eq(expected));
+    EXPECT_THAT(blocked, testing::Gt(expected.size() / 100));
+    EXPECT_THAT(writer.write(&sink), Eq(JsonWriter::COMPLETE));
+
+    ThrottledSink pretty_sink(1000);
+    JsonWriter pretty_writer(pretty_print(json));
+    while (pretty_writer.write(&pretty_sink) == JsonWriter::WOULD_BLOCK) { }
+    EXPECT_THAT(pretty_sink.bytes, Eq(utf8(sfz::String(pretty_print(json)))));
+
+    FailingSink failing;
+    JsonWriter failing_writer(json);
+    EXPECT_THAT(failing_writer.write(&failing), Eq(JsonWriter::SINK_ERROR));
+    EXPECT_THAT(failing_writer.write(&sink), Eq(JsonWriter::SINK_ERROR));
+}
+
+TEST_F(SerializeTest, WriterPipeTest) {
+    vector<Json> elements;
+    for (int i = 0; i < 40; ++i) {
+        elements.push_back(writer_document());
+    }
+    Json json = Json::array(elements);
+    const string expected = utf8(sfz::String(json));
+    ASSERT_THAT(expected.size(), testing::Gt(65536u));  // More than the pipe holds.
+
+    int fds[2];
+    ASSERT_THAT(pipe(fds), Eq(0));
+    ASSERT_THAT(fcntl(fds[1], F_SETFL, fcntl(fds[1], F_GETFL) | O_NONBLOCK), Eq(0));
+    FdSink sink(fds[1]);
+    JsonWriter writer(json);
+    string received;
+    JsonWriter::Status status;
+    while ((status = writer.write(&sink)) == JsonWriter::WOULD_BLOCK) {
+        char buffer[4096];
+        ssize_t size = read(fds[0], buffer, sizeof(buffer));
+        ASSERT_THAT(size, testing::Gt(0));
+        received.append(buffer, size);
+    }
+    ASSERT_THAT(status, Eq(JsonWriter::COMPLETE));
+    close(fds[1]);
+    char buffer[4096];
+    ssize_t size;
+    while ((size = read(fds[0], buffer, sizeof(buffer))) > 0) {
+        received.append(buffer, size);
+    }
+    close(fds[0]);
+    EXPECT_THAT(received, Eq(expected));
+}
+
+TEST_F(SerializeTest, NdjsonTest) {
+    StringMap<Json> o;
+    o.insert(make_pair("a", Json::bool_(true)));
+    vector<Json> values;
+    values.push_back(Json::object(o));
+    values.push_back(Json::string("x"));
+
+    // Below the flush size, nothing reaches the sink until flush().
+    ThrottledSink sink(4);
+    NdjsonWriter writer(&sink, 1000);
+    EXPECT_TRUE(writer.write(Json()));
+    EXPECT_TRUE(writer.write(values));
+    EXPECT_THAT(writer.pending(), Eq(20u));
+    EXPECT_THAT(sink.bytes, Eq(string()));
+    size_t blocked = 0;
+    while (writer.flush() == JsonWriter::WOULD_BLOCK) {
+        ++blocked;
+    }
+    EXPECT_THAT(blocked, Eq(9u));
+    EXPECT_THAT(writer.pending(), Eq(0u));
+    EXPECT_THAT(sink.bytes, Eq(string("null\n{\"a\":true}\n\"x\"\n")));
+
+    // At the flush size, write() flushes by itself.  The first flush finds the sink full, so
+    // the first record stays pending until the second flush.
+    ThrottledSink eager_sink(1000);
+    NdjsonWriter eager_writer(&eager_sink, 8);
+    EXPECT_TRUE(eager_writer.write(values[0]));
+    EXPECT_THAT(eager_sink.bytes, Eq(string()));
+    EXPECT_THAT(eager_writer.pending(), Eq(11u));
+    EXPECT_TRUE(eager_writer.write(values[1]));
+    EXPECT_THAT(eager_sink.bytes, Eq(string("{\"a\":true}\n\"x\"\n")));
+    EXPECT_THAT(eager_writer.pending(), Eq(0u));
+
+    FailingSink failing;
+    NdjsonWriter failing_writer(&failing, 1);
+    EXPECT_FALSE(failing_writer.write(Json()));
+    EXPECT_FALSE(failing_writer.write(Json()));
+    EXPECT_THAT(failing_writer.flush(), Eq(JsonWriter::SINK_ERROR));
+}
+
+TEST_F(SerializeTest, CanonicalTest) {
+    const struct {
+        double value;
+        const char* canonical;
+    } numbers[] = {
+        {0.0, "0"},
+        {-0.0, "0"},
+        {100.0, "100"},
+        {-1.5, "-1.5"},
+        {0.1, "0.1"},
+        {1.0 / 3.0, "0.3333333333333333"},
+        {9007199254740992.0, "9007199254740992"},
+        {1e21, "1e21"},
+        {1.2345678901234567e20, "1.2345678901234567e20"},
+        {1e-7, "1e-7"},
+        {5e-324, "5e-324"},
+        {1.5e-323, "1.5e-323"},
+        {1.7976931348623157e308, "1.7976931348623157e308"},
+        {HUGE_VAL, "null"},
+        {-HUGE_VAL, "null"},
+        {HUGE_VAL - HUGE_VAL, "null"},
+    };
+    for (size_t i = 0; i < sizeof(numbers) / sizeof(numbers[0]); ++i) {
+        EXPECT_THAT(canonical(Json::number(numbers[i].value)), SerializesTo(numbers[i].canonical));
+    }
+
+    StringMap<Json> o;
+    o.insert(make_pair("b", Json::number(1e100)));
+    o.insert(make_pair("a", Json::string("tab\t\"q\"")));
+    vector<Json> a;
+    a.push_back(Json::object(o));
+    a.push_back(Json::bool_(false));
+    a.push_back(Json());
+    EXPECT_THAT(canonical(Json::array(a)),
+                SerializesTo("[{\"a\":\"tab\\t\\\"q\\\"\",\"b\":1e100},false,null]"));
+
+    // Members are ordered by code point, even where keys differ only after a character above
+    // U+00FF.
+    sfz::String a_macron;
+    a_macron.push(1, 0x101);
+    a_macron.push(1, 'a');
+    sfz::String capital_a_macron;
+    capital_a_macron.push(1, 0x100);
+    capital_a_macron.push(1, 'b');
+    StringMap<Json> macrons;
+    macrons.insert(make_pair(StringSlice(a_macron), Json::number(1)));
+    macrons.insert(make_pair(StringSlice(capital_a_macron), Json::number(2)));
+    sfz::String expected("{\"");
+    expected.push(capital_a_macron);
+    expected.push("\":2,\"");
+    expected.push(a_macron);
+    expected.push("\":1}");
+    EXPECT_THAT(canonical(Json::object(macrons)), SerializesTo(expected));
+
+    // Memoized serializations need not be canonical, so they are ignored.
+    const Json negative_zero = Json::number(-0.0);
+    memoize(negative_zero);
+    EXPECT_THAT(canonical(negative_zero), SerializesTo("0"));
+}
+
+TEST_F(SerializeTest, CanonicalHashTest) {
+    StringMap<Json> o;
+    o.insert(make_pair("number", Json::number(-0.0)));
+    sfz::String accented("caf");
+    accented.push(1, 0xe9);
+    o.insert(make_pair("string", Json::string(accented)));
+    const Json json = Json::object(o);
+    const string expected("{\"number\":0,\"string\":\"caf\xc3\xa9\"}");
+    EXPECT_THAT(canonical_hash(json), Eq(xxh64(expected.data(), expected.size())));
+    EXPECT_THAT(canonical_hash(json, 1), Eq(xxh64(expected.data(), expected.size(), 1)));
+
+    // Equal values have equal hashes, however they were built.
+    StringMap<Json> reordered;
+    reordered.insert(make_pair("string", Json::string(accented)));
+    reordered.insert(make_pair("number", Json::number(0.0)));
+    EXPECT_THAT(canonical_hash(Json::object(reordered)), Eq(canonical_hash(json)));
+    EXPECT_THAT(canonical_hash(Json::number(1)), testing::Ne(canonical_hash(Json::string("1"))));
+
+    // Output longer than the hasher's buffer is hashed in pieces.
+    vector<Json> elements(1000, json);
+    string long_expected("[");
+    for (size_t i = 0; i < elements.size(); ++i) {
+        long_expected += (i > 0) ? "," : "";
+        long_expected += expected;
+    }
+    long_expected += "]";
+    EXPECT_THAT(canonical_hash(Json::array(elements)),
+                Eq(xxh64(long_expected.data(), long_expected.size())));
+}
+
 }  // namespace
 }  // namespace rgos
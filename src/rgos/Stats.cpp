@@ -0,0 +1,52 @@
+// Copyright (c) 2009 Chris Pickel <sfiera@gmail.com>
+//
+// This file is part of librgos, a free software project.  You can redistribute it and/or modify it
+// under the terms of the MIT License.
+
+#include "rgos/Stats.hpp"
+
+#include <sfz/sfz.hpp>
+#include "rgos/Json.hpp"
+
+using std::make_pair;
+
+namespace rgos {
+
+#ifdef RGOS_STATS
+
+namespace internal {
+JsonStats json_stats = { 0, 0, 0, 0, 0, 0 };
+}  // namespace internal
+
+JsonStats json_stats() {
+    return internal::json_stats;
+}
+
+void reset_json_stats() {
+    JsonStats zero = { 0, 0, 0, 0, 0, 0 };
+    internal::json_stats = zero;
+}
+
+#else  // RGOS_STATS
+
+JsonStats json_stats() {
+    JsonStats zero = { 0, 0, 0, 0, 0, 0 };
+    return zero;
+}
+
+void reset_json_stats() { }
+
+#endif  // RGOS_STATS
+
+Json stats_to_json(const JsonStats& stats) {
+    StringMap<Json> result;
+    result.insert(make_pair("allocations", Json::number(stats.allocations)));
+    result.insert(make_pair("allocated_bytes", Json::number(stats.allocated_bytes)));
+    result.insert(make_pair("string_map_lookups", Json::number(stats.string_map_lookups)));
+    result.insert(make_pair("serializations", Json::number(stats.serializations)));
+    result.insert(make_pair("serialized_chars", Json::number(stats.serialized_chars)));
+    result.insert(make_pair("serialize_usecs", Json::number(stats.serialize_usecs)));
+    return Json::object(result);
+}
+
+}  // namespace rgos
@@ -0,0 +1,118 @@
+// Copyright (c) 2009 Chris Pickel <sfiera@gmail.com>
+//
+// This file is part of librgos, a free software project.  You can redistribute it and/or modify it
+// under the terms of the MIT License.
+
+#include "rgos/Stats.hpp"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <sfz/sfz.hpp>
+#include "rgos/ByteSink.hpp"
+#include "rgos/Json.hpp"
+#include "rgos/Serialize.hpp"
+
+using sfz::String;
+using std::make_pair;
+using std::vector;
+using testing::Eq;
+
+namespace rgos {
+namespace {
+
+// Accepts everything, counting the bytes.
+class CountingSink : public ByteSink {
+  public:
+    CountingSink() : size(0) { }
+
+    virtual bool write(const char* data, size_t size, size_t* written) {
+        this->size += size;
+        *written = size;
+        return true;
+    }
+
+    size_t size;
+};
+
+typedef ::testing::Test StatsTest;
+
+TEST_F(StatsTest, ResetTest) {
+    Json::number(1.0);
+    reset_json_stats();
+    JsonStats stats = json_stats();
+    EXPECT_THAT(stats.allocations, Eq(0u));
+    EXPECT_THAT(stats.allocated_bytes, Eq(0u));
+    EXPECT_THAT(stats.string_map_lookups, Eq(0u));
+    EXPECT_THAT(stats.serializations, Eq(0u));
+    EXPECT_THAT(stats.serialized_chars, Eq(0u));
+}
+
+TEST_F(StatsTest, CountTest) {
+    reset_json_stats();
+    StringMap<Json> o;
+    o.insert(make_pair("one", Json::number(1.0)));
+    o.find("one");
+    Json json = Json::object(o);
+    String out(json);
+    JsonStats stats = json_stats();
+
+#ifdef RGOS_STATS
+    // Number, entry "one" in `o`, its copy inside the Object, and the Object itself.
+    EXPECT_THAT(stats.allocations, Eq(4u));
+    // insert(), find(), and the insert() that copies `o` into the Object.
+    EXPECT_THAT(stats.string_map_lookups, Eq(3u));
+    EXPECT_THAT(stats.serializations, Eq(1u));
+    EXPECT_THAT(stats.serialized_chars, Eq(out.size()));
+#else
+    EXPECT_THAT(stats.allocations, Eq(0u));
+    EXPECT_THAT(stats.string_map_lookups, Eq(0u));
+    EXPECT_THAT(stats.serializations, Eq(0u));
+    EXPECT_THAT(stats.serialized_chars, Eq(0u));
+#endif  // RGOS_STATS
+}
+
+TEST_F(StatsTest, WriterTest) {
+    vector<Json> elements(3, Json::number(1.0));
+    Json json = Json::array(elements);
+    reset_json_stats();
+    CountingSink sink;
+    {
+        JsonWriter writer(json, 4);
+        EXPECT_THAT(writer.write(&sink), Eq(JsonWriter::COMPLETE));
+        EXPECT_THAT(writer.write(&sink), Eq(JsonWriter::COMPLETE));
+    }
+    {
+        // Each record counts as a serialization; the newlines that end them do not count.
+        NdjsonWriter writer(&sink);
+        EXPECT_THAT(writer.write(elements), Eq(true));
+        EXPECT_THAT(writer.flush(), Eq(JsonWriter::COMPLETE));
+    }
+    JsonStats stats = json_stats();
+
+#ifdef RGOS_STATS
+    EXPECT_THAT(stats.serializations, Eq(4u));
+    EXPECT_THAT(stats.serialized_chars, Eq(sink.size - elements.size()));
+#else
+    EXPECT_THAT(stats.serializations, Eq(0u));
+    EXPECT_THAT(stats.serialized_chars, Eq(0u));
+#endif  // RGOS_STATS
+}
+
+TEST_F(StatsTest, HashTest) {
+    vector<Json> elements(3, Json::number(1.0));
+    Json json = Json::array(elements);
+    reset_json_stats();
+    canonical_hash(json);
+    JsonStats stats = json_stats();
+
+#ifdef RGOS_STATS
+    EXPECT_THAT(stats.serializations, Eq(1u));
+    EXPECT_THAT(stats.serialized_chars, Eq(String(canonical(json)).size()));
+#else
+    EXPECT_THAT(stats.serializations, Eq(0u));
+    EXPECT_THAT(stats.serialized_chars, Eq(0u));
+#endif  // RGOS_STATS
+}
+
+}  // namespace
+}  // namespace rgos
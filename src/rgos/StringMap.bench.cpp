@@ -0,0 +1,76 @@
+// Copyright (c) 2009 Chris Pickel <sfiera@gmail.com>
+//
+// This file is part of librgos, a free software project.  You can redistribute it and/or modify it
+// under the terms of the MIT License.
+
+#include "rgos/StringMap.hpp"
+
+#include <vector>
+#include <sfz/sfz.hpp>
+#include "Bench.hpp"
+
+using sfz::String;
+using sfz::StringSlice;
+using sfz::linked_ptr;
+using std::make_pair;
+using std::vector;
+
+namespace rgos {
+namespace {
+
+// Lookup results are summed into this, so that the lookups can't be optimized away.
+volatile int sink;
+
+void make_keys(const StringSlice& prefix, size_t count, vector<linked_ptr<String> >* keys) {
+    for (size_t i = 0; i < count; ++i) {
+        keys->push_back(linked_ptr<String>(new String(bench_key(prefix, i * 7919 % count, 6))));
+    }
+}
+
+BENCHMARK(StringMapInsert1000) {
+    vector<linked_ptr<String> > keys;
+    make_keys("key", 1000, &keys);
+    state->start();
+    for (size_t i = 0; i < state->iterations; ++i) {
+        StringMap<int> map;
+        for (size_t j = 0; j < keys.size(); ++j) {
+            map.insert(make_pair(StringSlice(*keys[j]), int(j)));
+        }
+    }
+}
+
+BENCHMARK(StringMapFind1000) {
+    vector<linked_ptr<String> > keys;
+    make_keys("key", 1000, &keys);
+    StringMap<int> map;
+    for (size_t j = 0; j < keys.size(); ++j) {
+        map.insert(make_pair(StringSlice(*keys[j]), int(j)));
+    }
+    state->start();
+    int sum = 0;
+    for (size_t i = 0; i < state->iterations; ++i) {
+        sum += map.find(*keys[i % keys.size()])->second;
+    }
+    sink = sum;
+}
+
+// Keys share a 200-character prefix, so every comparison in the tree has to scan past it.
+BENCHMARK(StringMapFindSharedPrefix1000) {
+    String prefix;
+    prefix.push(200, 'k');
+    vector<linked_ptr<String> > keys;
+    make_keys(prefix, 1000, &keys);
+    StringMap<int> map;
+    for (size_t j = 0; j < keys.size(); ++j) {
+        map.insert(make_pair(StringSlice(*keys[j]), int(j)));
+    }
+    state->start();
+    int sum = 0;
+    for (size_t i = 0; i < state->iterations; ++i) {
+        sum += map.find(*keys[i % keys.size()])->second;
+    }
+    sink = sum;
+}
+
+}  // namespace
+}  // namespace rgos
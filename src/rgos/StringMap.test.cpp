@@ -0,0 +1,123 @@
+// Copyright (c) 2009 Chris Pickel <sfiera@gmail.com>
+//
+// This file is part of librgos, a free software project.  You can redistribute it and/or modify it
+// under the terms of the MIT License.
+
+#include "rgos/StringMap.hpp"
+
+#include <vector>
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <sfz/sfz.hpp>
+
+using sfz::Rune;
+using sfz::String;
+using sfz::StringSlice;
+using std::make_pair;
+using std::vector;
+using testing::Eq;
+
+namespace rgos {
+namespace {
+
+typedef ::testing::Test StringMapTest;
+
+TEST_F(StringMapTest, LessTest) {
+    StringSliceLess less;
+    EXPECT_THAT(less("", ""), Eq(false));
+    EXPECT_THAT(less("", "a"), Eq(true));
+    EXPECT_THAT(less("a", ""), Eq(false));
+    EXPECT_THAT(less("a", "ab"), Eq(true));
+    EXPECT_THAT(less("ab", "a"), Eq(false));
+    EXPECT_THAT(less("ab", "b"), Eq(true));
+    EXPECT_THAT(less("b", "ab"), Eq(false));
+    EXPECT_THAT(less("abc", "abc"), Eq(false));
+}
+
+TEST_F(StringMapTest, OrderTest) {
+    // Keys that agree in their first eight characters, or differ only past them, are ordered by
+    // their full text.
+    const char* const keys[] = {
+        "", "a", "ab", "abcdefgh", "abcdefgh", "abcdefghi", "abcdefghij", "abcdefgz", "b",
+    };
+    const size_t kKeys = sizeof(keys) / sizeof(keys[0]);
+    StringMap<int> map;
+    for (size_t i = kKeys; i > 0; --i) {
+        map.insert(make_pair(StringSlice(keys[i - 1]), int(i - 1)));
+    }
+    ASSERT_THAT(map.size(), Eq(kKeys - 1));
+
+    size_t i = 0;
+    for (StringMap<int>::iterator it = map.begin(); it != map.end(); ++it, ++i) {
+        if (i == 4) {
+            ++i;  // Duplicate.
+        }
+        EXPECT_THAT(it->first, Eq(StringSlice(keys[i])));
+    }
+    for (size_t j = 0; j < kKeys; ++j) {
+        ASSERT_THAT(map.find(keys[j]) != map.end(), Eq(true));
+        EXPECT_THAT(map.find(keys[j])->first, Eq(StringSlice(keys[j])));
+    }
+    EXPECT_THAT(map.find("abcdefg") == map.end(), Eq(true));
+    EXPECT_THAT(map.find("abcdefghk") == map.end(), Eq(true));
+}
+
+TEST_F(StringMapTest, NonAsciiTest) {
+    // Characters above U+00FF share a byte in the prefix word, so they must be told apart by
+    // comparing the text itself.
+    String first("x");
+    first.push(1, 0x100);
+    String second("x");
+    second.push(1, 0x101);
+    String third("x");
+    third.push(1, 0xff);
+
+    StringMap<int> map;
+    map[second] = 2;
+    map[first] = 1;
+    map[third] = 0;
+    StringMap<int>::iterator it = map.begin();
+    EXPECT_THAT(it->second, Eq(0));
+    ++it;
+    EXPECT_THAT(it->second, Eq(1));
+    ++it;
+    EXPECT_THAT(it->second, Eq(2));
+    EXPECT_THAT(map.find(second)->second, Eq(2));
+    EXPECT_THAT(map.erase(first), Eq(1u));
+    EXPECT_THAT(map.find(first) == map.end(), Eq(true));
+}
+
+TEST_F(StringMapTest, NonLatin1Test) {
+    // Keys that differ only after a character of U+00FF or above keep code point order.
+    const Rune keys[][2] = {
+        {0xff, 'z'},
+        {0x100, 'a'},
+        {0x100, 'b'},
+        {0x101, 'a'},
+        {0x3b1, 0x3b2},
+    };
+    const size_t count = sizeof(keys) / sizeof(keys[0]);
+    vector<String> strings;
+    for (size_t i = 0; i < count; ++i) {
+        String key;
+        key.push(1, keys[i][0]);
+        key.push(1, keys[i][1]);
+        strings.push_back(key);
+    }
+
+    StringMap<int> map;
+    for (size_t i = count; i > 0; --i) {
+        map[strings[i - 1]] = i - 1;
+    }
+    int expected = 0;
+    for (StringMap<int>::iterator it = map.begin(); it != map.end(); ++it) {
+        EXPECT_THAT(it->second, Eq(expected++));
+    }
+    EXPECT_THAT(expected, Eq(int(count)));
+    for (size_t i = 0; i < count; ++i) {
+        EXPECT_THAT(map.find(strings[i])->second, Eq(int(i)));
+    }
+}
+
+}  // namespace
+}  // namespace rgos
@@ -0,0 +1,115 @@
+// Copyright (c) 2009 Chris Pickel <sfiera@gmail.com>
+//
+// This file is part of librgos, a free software project.  You can redistribute it and/or modify it
+// under the terms of the MIT License.
+
+#include "rgos/Utf8.hpp"
+
+#include <string>
+#include <sfz/sfz.hpp>
+#include "rgos/Json.hpp"
+#include "rgos/Serialize.hpp"
+#include "Bench.hpp"
+
+using sfz::String;
+using std::string;
+
+namespace rgos {
+namespace {
+
+// About 1 MiB of text made by repeating `phrase`.
+string repeat(const char* phrase) {
+    string result;
+    while (result.size() < (1 << 20)) {
+        result += phrase;
+    }
+    return result;
+}
+
+const string& ascii_text() {
+    static const string text = repeat("The quick brown fox jumps over the lazy dog. ");
+    return text;
+}
+
+// Mixes two-, three- and four-byte sequences with ASCII.
+const string& multilingual_text() {
+    static const string text = repeat(
+            "Gr\xc3\xbc\xc3\x9f" "e aus K\xc3\xb6ln, "
+            "\xe6\x97\xa5\xe6\x9c\xac\xe8\xaa\x9e\xe3\x81\xa7\xe3\x81\x99, "
+            "\xd0\xbf\xd1\x80\xd0\xb8\xd0\xb2\xd0\xb5\xd1\x82 \xf0\x9f\x98\x80. ");
+    return text;
+}
+
+void bench_validate(BenchState* state, const string& text) {
+    state->bytes = text.size();
+    state->start();
+    for (size_t i = 0; i < state->iterations; ++i) {
+        is_valid_utf8(text.data(), text.size());
+    }
+}
+
+void bench_decode(BenchState* state, const string& text) {
+    state->bytes = text.size();
+    state->start();
+    for (size_t i = 0; i < state->iterations; ++i) {
+        String decoded;
+        decode_utf8(text.data(), text.size(), UTF8_REJECT, &decoded);
+    }
+}
+
+// Builds a Json string from bytes, validating them on the way in.
+void bench_json_string(BenchState* state, const string& text) {
+    state->bytes = text.size();
+    state->start();
+    for (size_t i = 0; i < state->iterations; ++i) {
+        Json json;
+        Json::string(text.data(), text.size(), UTF8_REJECT, &json);
+    }
+}
+
+// Serializes a Json string, which scans it for characters to escape.
+void bench_escape(BenchState* state, const string& text) {
+    Json json;
+    Json::string(text.data(), text.size(), UTF8_REJECT, &json);
+    state->bytes = text.size();
+    state->start();
+    for (size_t i = 0; i < state->iterations; ++i) {
+        String out;
+        print_to(&out, json);
+    }
+}
+
+BENCHMARK(ValidateAscii1M) {
+    bench_validate(state, ascii_text());
+}
+
+BENCHMARK(ValidateMultilingual1M) {
+    bench_validate(state, multilingual_text());
+}
+
+BENCHMARK(DecodeAscii1M) {
+    bench_decode(state, ascii_text());
+}
+
+BENCHMARK(DecodeMultilingual1M) {
+    bench_decode(state, multilingual_text());
+}
+
+BENCHMARK(JsonStringAscii1M) {
+    bench_json_string(state, ascii_text());
+}
+
+BENCHMARK(JsonStringMultilingual1M) {
+    bench_json_string(state, multilingual_text());
+}
+
+BENCHMARK(EscapeAscii1M) {
+    bench_escape(state, ascii_text());
+}
+
+BENCHMARK(EscapeMultilingual1M) {
+    bench_escape(state, multilingual_text());
+}
+
+}  // namespace
+}  // namespace rgos
@@ -0,0 +1,174 @@
+// Copyright (c) 2009 Chris Pickel <sfiera@gmail.com>
+//
+// This file is part of librgos, a free software project.  You can redistribute it and/or modify it
+// under the terms of the MIT License.
+
+#include "rgos/Utf8.hpp"
+
+#include <stdint.h>
+#include <string.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif  // __SSE2__
+
+using sfz::Rune;
+using sfz::String;
+
+namespace rgos {
+
+namespace {
+
+const Rune kReplacementCharacter = 0xfffd;
+
+// The number of leading bytes of `data` that are ASCII.
+size_t ascii_prefix(const uint8_t* data, size_t size) {
+    size_t i = 0;
+#ifdef __SSE2__
+    for ( ; i + 16 <= size; i += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        int high_bits = _mm_movemask_epi8(chunk);
+        if (high_bits) {
+            return i + __builtin_ctz(high_bits);
+        }
+    }
+#else
+    for ( ; i + 8 <= size; i += 8) {
+        uint64_t chunk;
+        memcpy(&chunk, data + i, sizeof(chunk));
+        if (chunk & 0x8080808080808080ull) {
+            break;
+        }
+    }
+#endif  // __SSE2__
+    while ((i < size) && (data[i] < 0x80)) {
+        ++i;
+    }
+    return i;
+}
+
+// Decodes the sequence at the start of `data`, which must not be ASCII.  If it is well-formed,
+// stores its code point in `rune` and returns its length.  Otherwise, returns the length of
+// its maximal ill-formed subsequence, negated.
+int decode_sequence(const uint8_t* data, size_t size, Rune* rune) {
+    const uint8_t lead = data[0];
+    int length;
+    uint8_t low = 0x80, high = 0xbf;  // Bounds on the second byte.
+    if ((lead >= 0xc2) && (lead <= 0xdf)) {
+        length = 2;
+        *rune = lead & 0x1f;
+    } else if ((lead >= 0xe0) && (lead <= 0xef)) {
+        length = 3;
+        *rune = lead & 0x0f;
+        if (lead == 0xe0) {
+            low = 0xa0;  // Overlong.
+        } else if (lead == 0xed) {
+            high = 0x9f;  // Surrogates.
+        }
+    } else if ((lead >= 0xf0) && (lead <= 0xf4)) {
+        length = 4;
+        *rune = lead & 0x07;
+        if (lead == 0xf0) {
+            low = 0x90;  // Overlong.
+        } else if (lead == 0xf4) {
+            high = 0x8f;  // Above U+10FFFF.
+        }
+    } else {
+        return -1;
+    }
+
+    for (int i = 1; i < length; ++i) {
+        if ((size_t(i) >= size) || (data[i] < low) || (data[i] > high)) {
+            return -i;
+        }
+        *rune = (*rune << 6) | (data[i] & 0x3f);
+        low = 0x80;
+        high = 0xbf;
+    }
+    return length;
+}
+
+}  // namespace
+
+size_t valid_utf8_prefix(const char* data, size_t size) {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+    size_t i = 0;
+    while (true) {
+        i += ascii_prefix(bytes + i, size - i);
+        if (i == size) {
+            return i;
+        }
+        Rune rune;
+        int length = decode_sequence(bytes + i, size - i, &rune);
+        if (length < 0) {
+            return i;
+        }
+        i += length;
+    }
+}
+
+bool is_valid_utf8(const char* data, size_t size) {
+    return valid_utf8_prefix(data, size) == size;
+}
+
+bool decode_utf8(const char* data, size_t size, Utf8Policy policy, String* out) {
+    // Each byte decodes to at most one code point, so `out` grows at most once.  With UTF8_REJECT,
+    // `out` is truncated back to `start` on the first ill-formed sequence, instead of validating
+    // the whole input before decoding it.
+    const size_t start = out->size();
+    out->reserve(start + size);
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+    size_t i = 0;
+    while (i < size) {
+        size_t ascii = ascii_prefix(bytes + i, size - i);
+        for (size_t end = i + ascii; i < end; ++i) {
+            out->push(1, bytes[i]);
+        }
+        if (i == size) {
+            break;
+        }
+        Rune rune;
+        int length = decode_sequence(bytes + i, size - i, &rune);
+        if (length > 0) {
+            out->push(1, rune);
+            i += length;
+        } else if (policy == UTF8_REJECT) {
+            out->resize(start);
+            return false;
+        } else if (policy == UTF8_REPLACE) {
+            out->push(1, kReplacementCharacter);
+            i += -length;
+        } else {
+            for (size_t end = i + -length; i < end; ++i) {
+                out->push(1, bytes[i]);
+            }
+        }
+    }
+    return true;
+}
+
+size_t encode_utf8(Rune rune, char* out) {
+    if (rune < 0x80) {
+        out[0] = rune;
+        return 1;
+    } else if (rune < 0x800) {
+        out[0] = 0xc0 | (rune >> 6);
+        out[1] = 0x80 | (rune & 0x3f);
+        return 2;
+    } else if ((rune >= 0xd800) && (rune < 0xe000)) {
+        return encode_utf8(kReplacementCharacter, out);
+    } else if (rune < 0x10000) {
+        out[0] = 0xe0 | (rune >> 12);
+        out[1] = 0x80 | ((rune >> 6) & 0x3f);
+        out[2] = 0x80 | (rune & 0x3f);
+        return 3;
+    } else if (rune < 0x110000) {
+        out[0] = 0xf0 | (rune >> 18);
+        out[1] = 0x80 | ((rune >> 12) & 0x3f);
+        out[2] = 0x80 | ((rune >> 6) & 0x3f);
+        out[3] = 0x80 | (rune & 0x3f);
+        return 4;
+    }
+    return encode_utf8(kReplacementCharacter, out);
+}
+
+}  // namespace rgos
@@ -0,0 +1,111 @@
+// Copyright (c) 2009 Chris Pickel <sfiera@gmail.com>
+//
+// This file is part of librgos, a free software project.  You can redistribute it and/or modify it
+// under the terms of the MIT License.
+
+#include "rgos/Utf8.hpp"
+
+#include <string>
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <sfz/sfz.hpp>
+
+using sfz::Rune;
+using sfz::String;
+using testing::Eq;
+
+namespace rgos {
+namespace {
+
+typedef ::testing::Test Utf8Test;
+
+template <size_t N>
+size_t prefix(const char (&data)[N]) {
+    return valid_utf8_prefix(data, N - 1);
+}
+
+template <size_t N>
+String decode(const char (&data)[N], Utf8Policy policy) {
+    String result("<");
+    if (!decode_utf8(data, N - 1, policy, &result)) {
+        result.push("rejected");
+    }
+    result.push(1, '>');
+    return result;
+}
+
+String runes(Rune a, Rune b = 0, Rune c = 0, Rune d = 0) {
+    String result("<");
+    Rune all[] = {a, b, c, d};
+    for (int i = 0; (i < 4) && all[i]; ++i) {
+        result.push(1, all[i]);
+    }
+    result.push(1, '>');
+    return result;
+}
+
+TEST_F(Utf8Test, ValidTest) {
+    EXPECT_THAT(prefix(""), Eq(0u));
+    EXPECT_THAT(prefix("Hello, world!"), Eq(13u));
+    EXPECT_THAT(prefix("caf\xc3\xa9"), Eq(5u));
+    EXPECT_THAT(prefix("\xe6\x97\xa5\xe6\x9c\xac"), Eq(6u));
+    EXPECT_THAT(prefix("\xf0\x9f\x98\x80"), Eq(4u));
+    EXPECT_THAT(prefix("\xef\xbf\xbf\xf4\x8f\xbf\xbf"), Eq(7u));
+
+    EXPECT_THAT(decode("caf\xc3\xa9", UTF8_REJECT), Eq(runes('c', 'a', 'f', 0xe9)));
+    EXPECT_THAT(decode("\xe6\x97\xa5", UTF8_REJECT), Eq(runes(0x65e5)));
+    EXPECT_THAT(decode("\xf0\x9f\x98\x80", UTF8_REJECT), Eq(runes(0x1f600)));
+}
+
+TEST_F(Utf8Test, InvalidTest) {
+    EXPECT_THAT(prefix("\x80"), Eq(0u));                  // Stray continuation byte.
+    EXPECT_THAT(prefix("a\xc0\xaf"), Eq(1u));             // Overlong '/'.
+    EXPECT_THAT(prefix("ab\xe0\x80\xaf"), Eq(2u));        // Overlong '/'.
+    EXPECT_THAT(prefix("\xed\xa0\x80"), Eq(0u));          // Surrogate.
+    EXPECT_THAT(prefix("\xf4\x90\x80\x80"), Eq(0u));      // Above U+10FFFF.
+    EXPECT_THAT(prefix("\xf5\x80\x80\x80"), Eq(0u));
+    EXPECT_THAT(prefix("\xe6\x97"), Eq(0u));              // Truncated.
+    EXPECT_THAT(prefix("\xff"), Eq(0u));
+
+    // Errors past the vectorized ASCII scan are found at the right offset.
+    EXPECT_THAT(prefix("0123456789abcdef0123456789abcdef01234\xff"), Eq(37u));
+    EXPECT_THAT(prefix("0123456789abcdef0123456789abcdef\xc3\xa9\xc3"), Eq(34u));
+    EXPECT_THAT(is_valid_utf8("\xc3\xa9", 2), Eq(true));
+    EXPECT_THAT(is_valid_utf8("\xc3\xa9", 1), Eq(false));
+}
+
+TEST_F(Utf8Test, PolicyTest) {
+    EXPECT_THAT(decode("a\xe6\x97" "b", UTF8_REJECT), Eq(String("<rejected>")));
+    EXPECT_THAT(decode("0123456789abcdef0123456789abcdef\xc3\xa9\xff", UTF8_REJECT),
+                Eq(String("<rejected>")));
+
+    // A truncated sequence is replaced as a unit; invalid bytes are each replaced.
+    EXPECT_THAT(decode("a\xe6\x97" "b", UTF8_REPLACE), Eq(runes('a', 0xfffd, 'b')));
+    EXPECT_THAT(decode("\xc0\xaf", UTF8_REPLACE), Eq(runes(0xfffd, 0xfffd)));
+    EXPECT_THAT(decode("\xed\xa0\x80", UTF8_REPLACE), Eq(runes(0xfffd, 0xfffd, 0xfffd)));
+
+    EXPECT_THAT(decode("a\xe6\x97" "b", UTF8_PASS_THROUGH), Eq(runes('a', 0xe6, 0x97, 'b')));
+    EXPECT_THAT(decode("caf\xe9", UTF8_PASS_THROUGH), Eq(runes('c', 'a', 'f', 0xe9)));
+}
+
+TEST_F(Utf8Test, EncodeTest) {
+    const Rune runes[] = {'a', 0x7f, 0x80, 0xe9, 0x7ff, 0x800, 0x65e5, 0xfffd, 0x10000, 0x1f600,
+                          0x10ffff};
+    for (size_t i = 0; i < sizeof(runes) / sizeof(runes[0]); ++i) {
+        char bytes[4];
+        size_t size = encode_utf8(runes[i], bytes);
+        String decoded;
+        ASSERT_THAT(decode_utf8(bytes, size, UTF8_REJECT, &decoded), Eq(true));
+        ASSERT_THAT(decoded.size(), Eq(1u));
+        EXPECT_THAT(decoded.at(0), Eq(runes[i]));
+    }
+
+    char bytes[4];
+    EXPECT_THAT(encode_utf8(0xd800, bytes), Eq(3u));
+    EXPECT_THAT(std::string(bytes, 3), Eq(std::string("\xef\xbf\xbd")));
+    EXPECT_THAT(encode_utf8(0x110000, bytes), Eq(3u));
+    EXPECT_THAT(std::string(bytes, 3), Eq(std::string("\xef\xbf\xbd")));
+}
+
+}  // namespace
+}  // namespace rgos
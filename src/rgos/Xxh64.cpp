@@ -0,0 +1,126 @@
+// Copyright (c) 2009 Chris Pickel <sfiera@gmail.com>
+//
+// This file is part of librgos, a free software project.  You can redistribute it and/or modify it
+// under the terms of the MIT License.
+
+#include "rgos/Xxh64.hpp"
+
+#include <string.h>
+#include <algorithm>
+
+namespace rgos {
+
+namespace {
+
+const uint64_t kPrime1 = 11400714785074694791ull;
+const uint64_t kPrime2 = 14029467366897019727ull;
+const uint64_t kPrime3 = 1609587929392839161ull;
+const uint64_t kPrime4 = 9650029242287828579ull;
+const uint64_t kPrime5 = 2870177450012600261ull;
+
+inline uint64_t rotate_left(uint64_t value, int bits) {
+    return (value << bits) | (value >> (64 - bits));
+}
+
+// Input words are little-endian regardless of the host.
+inline uint64_t read64(const char* data) {
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+    uint64_t result = 0;
+    for (int i = 7; i >= 0; --i) {
+        result = (result << 8) | bytes[i];
+    }
+    return result;
+}
+
+inline uint64_t read32(const char* data) {
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+    return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | (uint64_t(bytes[3]) << 24);
+}
+
+inline uint64_t accumulate(uint64_t accumulator, uint64_t input) {
+    return rotate_left(accumulator + (input * kPrime2), 31) * kPrime1;
+}
+
+inline uint64_t merge_round(uint64_t hash, uint64_t accumulator) {
+    return ((hash ^ accumulate(0, accumulator)) * kPrime1) + kPrime4;
+}
+
+}  // namespace
+
+Xxh64::Xxh64(uint64_t seed)
+    : _seed(seed),
+      _total_size(0),
+      _stripe_size(0) {
+    _accumulators[0] = seed + kPrime1 + kPrime2;
+    _accumulators[1] = seed + kPrime2;
+    _accumulators[2] = seed;
+    _accumulators[3] = seed - kPrime1;
+}
+
+void Xxh64::update(const char* data, size_t size) {
+    _total_size += size;
+    if (_stripe_size > 0) {
+        const size_t fill = std::min(size, sizeof(_stripe) - _stripe_size);
+        memcpy(_stripe + _stripe_size, data, fill);
+        _stripe_size += fill;
+        data += fill;
+        size -= fill;
+        if (_stripe_size < sizeof(_stripe)) {
+            return;
+        }
+        for (int i = 0; i < 4; ++i) {
+            _accumulators[i] = accumulate(_accumulators[i], read64(_stripe + (8 * i)));
+        }
+        _stripe_size = 0;
+    }
+    for ( ; size >= 32; data += 32, size -= 32) {
+        for (int i = 0; i < 4; ++i) {
+            _accumulators[i] = accumulate(_accumulators[i], read64(data + (8 * i)));
+        }
+    }
+    memcpy(_stripe, data, size);
+    _stripe_size = size;
+}
+
+uint64_t Xxh64::digest() const {
+    uint64_t hash;
+    if (_total_size >= 32) {
+        hash = rotate_left(_accumulators[0], 1) + rotate_left(_accumulators[1], 7)
+            + rotate_left(_accumulators[2], 12) + rotate_left(_accumulators[3], 18);
+        for (int i = 0; i < 4; ++i) {
+            hash = merge_round(hash, _accumulators[i]);
+        }
+    } else {
+        hash = _seed + kPrime5;
+    }
+    hash += _total_size;
+
+    const char* data = _stripe;
+    size_t size = _stripe_size;
+    for ( ; size >= 8; data += 8, size -= 8) {
+        hash = (rotate_left(hash ^ accumulate(0, read64(data)), 27) * kPrime1) + kPrime4;
+    }
+    if (size >= 4) {
+        hash = (rotate_left(hash ^ (read32(data) * kPrime1), 23) * kPrime2) + kPrime3;
+        data += 4;
+        size -= 4;
+    }
+    for ( ; size > 0; ++data, --size) {
+        hash = rotate_left(hash ^ (uint64_t(uint8_t(*data)) * kPrime5), 11) * kPrime1;
+    }
+
+    hash ^= hash >> 33;
+    hash *= kPrime2;
+    hash ^= hash >> 29;
+    hash *= kPrime3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+uint64_t xxh64(const char* data, size_t size, uint64_t seed) {
+    Xxh64 hasher(seed);
+    hasher.update(data, size);
+    return hasher.digest();
+}
+
+}  // namespace rgos
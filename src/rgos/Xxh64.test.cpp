@@ -0,0 +1,52 @@
+// Copyright (c) 2009 Chris Pickel <sfiera@gmail.com>
+//
+// This file is part of librgos, a free software project.  You can redistribute it and/or modify it
+// under the terms of the MIT License.
+
+#include "rgos/Xxh64.hpp"
+
+#include <string.h>
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+using testing::Eq;
+
+namespace rgos {
+namespace {
+
+typedef ::testing::Test Xxh64Test;
+
+uint64_t hash(const char* data, uint64_t seed = 0) {
+    return xxh64(data, strlen(data), seed);
+}
+
+// Tests against the reference implementation's output.
+TEST_F(Xxh64Test, KnownTest) {
+    EXPECT_THAT(hash(""), Eq(0xef46db3751d8e999ull));
+    EXPECT_THAT(hash("a"), Eq(0xd24ec4f1a98c6e5bull));
+    EXPECT_THAT(hash("abc"), Eq(0x44bc2cf5ad770999ull));
+    EXPECT_THAT(hash("Nobody inspects the spammish repetition"), Eq(0xfbcea83c8a378bf1ull));
+}
+
+// Tests that input fed in pieces of any size hashes the same as when fed at once.
+TEST_F(Xxh64Test, IncrementalTest) {
+    char data[200];
+    for (size_t i = 0; i < sizeof(data); ++i) {
+        data[i] = i * 37;
+    }
+    for (size_t size = 0; size <= sizeof(data); size += 13) {
+        const uint64_t expected = xxh64(data, size, 7);
+        for (size_t piece = 1; piece <= 40; ++piece) {
+            Xxh64 hasher(7);
+            for (size_t i = 0; i < size; i += piece) {
+                hasher.update(data + i, std::min(piece, size - i));
+                EXPECT_THAT(hasher.digest(), Eq(xxh64(data, std::min(i + piece, size), 7)));
+            }
+            EXPECT_THAT(hasher.digest(), Eq(expected)) << size << " in pieces of " << piece;
+        }
+    }
+}
+
+}  // namespace
+}  // namespace rgos